@@ -52,6 +52,13 @@ static MDFN_PixelFormat last_pixel_format;
 
 static MDFN_Surface surf;
 
+/* Frame pipelining: frames alternate between surf and pipe_surf, and
+ * each frame is presented one retro_run() after it was emulated. */
+static MDFN_Surface pipe_surf;
+static unsigned pipe_which;
+static bool pipe_prev_valid;
+static EmulateSpecStruct pipe_prev;
+
 static bool failed_init;
 
 
@@ -403,8 +410,8 @@ static bool LoadCommon(std::vector<CDIF *> *CDInterfaces)
       fx_vdc_chips[i]->SetIRQHook(i ? VDCB_IRQHook : VDCA_IRQHook);
    }
 
-   SoundBox_Init(MDFN_GetSettingB("pcfx.adpcm.emulate_buggy_codec"), MDFN_GetSettingB("pcfx.adpcm.suppress_channel_reset_clicks"));
-   RAINBOW_Init(MDFN_GetSettingB("pcfx.rainbow.chromaip"));
+   SoundBox_Init(MDFN_GetSettingB("pcfx.adpcm.emulate_buggy_codec"), MDFN_GetSettingB("pcfx.adpcm.suppress_channel_reset_clicks"), MDFN_GetSettingB("pcfx.psg.batch"));
+   RAINBOW_Init(MDFN_GetSettingB("pcfx.rainbow.chromaip"), MDFN_GetSettingB("pcfx.rainbow.async"), MDFN_GetSettingUI("pcfx.rainbow.cache"));
    FXINPUT_Init();
    FXTIMER_Init();
 
@@ -788,7 +795,7 @@ static Deinterlacer deint;
 
 #define FB_MAX_HEIGHT FB_HEIGHT
 
-static bool cdimagecache = false;
+static unsigned cdimagecache = CDACCESS_IMAGE_STREAM;
 
 static std::vector<CDIF *> CDInterfaces;	// FIXME: Cleanup on error out.
 // TODO: LoadCommon()
@@ -1068,11 +1075,32 @@ static void check_variables(bool loaded)
    if (!loaded)
    {
       var.key      = "pcfx_cdimagecache";
-      cdimagecache = false;
+      cdimagecache = CDACCESS_IMAGE_STREAM;
 
       if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+      {
          if (strcmp(var.value, "enabled") == 0)
-            cdimagecache = true;
+            cdimagecache = CDACCESS_IMAGE_MEMCACHE;
+         else if (strcmp(var.value, "mmap") == 0)
+            cdimagecache = CDACCESS_IMAGE_MMAP;
+         else if (strcmp(var.value, "decompress") == 0)
+            cdimagecache = CDACCESS_IMAGE_DECOMPRESS;
+      }
+
+      var.key = "pcfx_chd_hunk_cache";
+
+      if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+         setting_chd_hunk_cache = atoi(var.value);
+
+      var.key = "pcfx_chd_prefetch";
+
+      if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+         setting_chd_prefetch = atoi(var.value);
+
+      var.key = "pcfx_cd_readahead";
+
+      if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+         setting_cd_readahead = atoi(var.value);
    }
 
    var.key = "pcfxtreme_high_dotclock_width";
@@ -1133,6 +1161,16 @@ static void check_variables(bool loaded)
          setting_emulate_buggy_codec = 1;
    }
 
+   var.key = "pcfx_psg_batch";
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+   {
+      if (strcmp(var.value, "disabled") == 0)
+         setting_psg_batch = 0;
+      else if (strcmp(var.value, "enabled") == 0)
+         setting_psg_batch = 1;
+   }
+
    var.key = "pcfx_rainbow_chromaip";
 
    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
@@ -1143,6 +1181,47 @@ static void check_variables(bool loaded)
          setting_rainbow_chromaip = 1;
    }
 
+   var.key = "pcfx_rainbow_async";
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+   {
+      if (strcmp(var.value, "disabled") == 0)
+         setting_rainbow_async = 0;
+      else if (strcmp(var.value, "enabled") == 0)
+         setting_rainbow_async = 1;
+   }
+
+   var.key = "pcfx_rainbow_cache";
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+   {
+      setting_rainbow_cache = atoi(var.value);
+   }
+
+   var.key = "pcfx_frame_pipelining";
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+   {
+      if (strcmp(var.value, "disabled") == 0)
+         setting_frame_pipelining = 0;
+      else if (strcmp(var.value, "enabled") == 0)
+         setting_frame_pipelining = 1;
+   }
+
+#ifdef NEED_DEINTERLACER
+   var.key = "pcfx_deinterlacer";
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+   {
+      if (strcmp(var.value, "weave") == 0)
+         deint.SetType(Deinterlacer::DEINT_WEAVE);
+      else if (strcmp(var.value, "bob") == 0)
+         deint.SetType(Deinterlacer::DEINT_BOB);
+      else if (strcmp(var.value, "blend") == 0)
+         deint.SetType(Deinterlacer::DEINT_BLEND);
+   }
+#endif
+
    var.key = "pcfx_mouse_sensitivity";
 
    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
@@ -1368,6 +1447,17 @@ bool retro_load_game(const struct retro_game_info *info)
    surf.h                       = FB_HEIGHT;
    surf.pitchinpix              = FB_WIDTH;
 
+   pipe_which                   = 0;
+   pipe_prev_valid              = false;
+
+   if (KING_GetFramePipelining() && !pipe_surf.pixels)
+   {
+      pipe_surf = surf;
+
+      if (!(pipe_surf.pixels = (bpp_t*)calloc(1, FB_WIDTH * FB_HEIGHT * (pix_fmt.bpp >> 3))))
+         return false;
+   }
+
 #ifdef NEED_DEINTERLACER
    PrevInterlaced = false;
    deint.ClearState();
@@ -1480,15 +1570,16 @@ void retro_run(void)
    update_input();
 
    static int16_t sound_buf[0x10000];
-   static int32 rects[FB_MAX_HEIGHT];
+   static int32 rects[2][FB_MAX_HEIGHT];
    static unsigned width, height;
    bool resolution_changed = false;
-   rects[0] = ~0;
+   bool frame_pipelining   = KING_GetFramePipelining();
+   rects[pipe_which][0]    = ~0;
 
    EmulateSpecStruct spec  = {0};
-   spec.surface            = &surf;
+   spec.surface            = pipe_which ? &pipe_surf : &surf;
    spec.SoundBuf           = sound_buf;
-   spec.LineWidths         = rects;
+   spec.LineWidths         = rects[pipe_which];
    spec.SoundBufMaxSize    = sizeof(sound_buf) / 2;
    spec.SoundBufSize       = 0;
    spec.VideoFormatChanged = false;
@@ -1501,31 +1592,59 @@ void retro_run(void)
 
    Emulate(&spec);
 
+   /* Frame whose video gets presented this time. */
+   EmulateSpecStruct *vspec = &spec;
+   bool pipe_first          = false;
+
+   if (frame_pipelining)
+   {
+      /* KING_EndFrame() has handed the frame just emulated over to the
+       * render thread, after waiting for the previous one to complete.
+       * Present that previous frame; the very first frame has none, so
+       * wait for it and present it directly (it will be shown twice). */
+      if (!pipe_prev_valid)
+      {
+         KING_WaitFrame();
+         pipe_prev       = spec;
+         pipe_prev_valid = true;
+         pipe_first      = true;
+      }
+
+      vspec = &pipe_prev;
+   }
+
 #ifdef NEED_DEINTERLACER
-   if (spec.InterlaceOn)
+   if (vspec->InterlaceOn)
    {
       if (!PrevInterlaced)
          deint.ClearState();
 
-      deint.Process(spec.surface, spec.DisplayRect, spec.LineWidths, spec.InterlaceField);
+      deint.Process(vspec->surface, vspec->DisplayRect, vspec->LineWidths, vspec->InterlaceField);
 
       PrevInterlaced = true;
 
-      spec.InterlaceOn = false;
-      spec.InterlaceField = 0;
+      vspec->InterlaceOn = false;
+      vspec->InterlaceField = 0;
    }
    else
       PrevInterlaced = false;
 #endif
 
-   if (width  != spec.DisplayRect.w || height != spec.DisplayRect.h)
+   if (width  != vspec->DisplayRect.w || height != vspec->DisplayRect.h)
       resolution_changed = true;
 
-   width  = spec.DisplayRect.w;
-   height = spec.DisplayRect.h;
+   width  = vspec->DisplayRect.w;
+   height = vspec->DisplayRect.h;
 
-   size_t pitch = FB_WIDTH * (spec.surface->format.bpp >> 3);
-   video_cb(spec.surface->pixels + spec.surface->pitchinpix * spec.DisplayRect.y, width, height, pitch);
+   size_t pitch = FB_WIDTH * (vspec->surface->format.bpp >> 3);
+   video_cb(vspec->surface->pixels + vspec->surface->pitchinpix * vspec->DisplayRect.y, width, height, pitch);
+
+   if (frame_pipelining)
+   {
+      if (!pipe_first)
+         pipe_prev = spec;
+      pipe_which ^= 1;
+   }
 
    bool updated = false;
    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE, &updated) && updated)
@@ -1571,6 +1690,11 @@ void retro_deinit(void)
       free(surf.pixels);
 
    surf.pixels            = NULL;
+
+   if (pipe_surf.pixels)
+      free(pipe_surf.pixels);
+
+   pipe_surf.pixels       = NULL;
    surf.w                 = 0;
    surf.h                 = 0;
    surf.pitchinpix        = 0;
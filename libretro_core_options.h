@@ -42,16 +42,67 @@ struct retro_core_option_v2_definition option_defs_us[] = {
       "pcfx_cdimagecache",
       "CD Image Cache (Restart Required)",
       NULL,
-      "Load the complete image into memory at startup. Can potentially decrease loading times at the cost of an increased startup time.",
+      "Load the complete image into memory. Can potentially decrease loading times. On threaded builds the image is loaded in the background while the game runs; otherwise it is loaded at startup, increasing startup time. 'Memory-Mapped' maps BIN/IMG files into memory instead, for the same fast sector access without the startup delay or a second copy of the image in RAM. 'Decompress CHD' also decompresses CHD images in full at startup, using all CPU cores, so that no decompression is needed while playing.",
       NULL,
       NULL,
       {
          { "disabled", NULL },
          { "enabled", NULL },
+         { "mmap", "Memory-Mapped" },
+         { "decompress", "Decompress CHD" },
          { NULL, NULL},
       },
       "disabled"
    },
+   {
+      "pcfx_chd_hunk_cache",
+      "CHD Hunk Cache (Restart Required)",
+      NULL,
+      "Number of decompressed CHD hunks (8 sectors each) kept in memory, so that going back and forth between parts of the disc, such as game data and CD audio, doesn't decompress the same hunks over and over.",
+      NULL,
+      NULL,
+      {
+         { "1",  NULL },
+         { "8",  NULL },
+         { "16", NULL },
+         { "32", NULL },
+         { "64", NULL },
+         { NULL, NULL},
+      },
+      "16",
+   },
+   {
+      "pcfx_chd_prefetch",
+      "CHD Prefetch (Restart Required)",
+      NULL,
+      "Number of CHD hunks decompressed ahead of the read position on background threads. Reduces stutter when loading from CHD images on multi-core devices.",
+      NULL,
+      NULL,
+      {
+         { "0", "disabled" },
+         { "2", NULL },
+         { "4", NULL },
+         { "8", NULL },
+         { NULL, NULL},
+      },
+      "4",
+   },
+   {
+      "pcfx_cd_readahead",
+      "CD Read-Ahead (Restart Required)",
+      NULL,
+      "Maximum number of sectors read ahead of the emulated CD drive while it's reading sequentially, such as during FMV or CD audio. Read-ahead starts small and ramps up to this depth, and drops back down on seeks. Higher values help with slow storage, such as network shares and SD cards. Not used for CHD images fully decompressed by 'Decompress CHD'.",
+      NULL,
+      NULL,
+      {
+         { "16",  NULL },
+         { "32",  NULL },
+         { "64",  NULL },
+         { "128", NULL },
+         { NULL, NULL},
+      },
+      "64",
+   },
    {
       "pcfxtreme_high_dotclock_width",
       "High Dotclock Width (Restart Required)",
@@ -95,6 +146,20 @@ struct retro_core_option_v2_definition option_defs_us[] = {
       },
       "disabled",
    },
+   {
+      "pcfx_psg_batch",
+      "Batched PSG Synthesis (Restart Required)",
+      NULL,
+      "When the PSG plays very high-frequency waveforms or noise, gather its output transitions and filter them in one pass instead of one at a time. Only kicks in when that comes out ahead. Output is unchanged.",
+      NULL,
+      NULL,
+      {
+         { "disabled", NULL },
+         { "enabled",  NULL },
+         { NULL, NULL},
+      },
+      "disabled",
+   },
    {
       "pcfxtreme_resamp_quality",
       "Sound Quality (Restart Required)",
@@ -131,6 +196,68 @@ struct retro_core_option_v2_definition option_defs_us[] = {
       },
       "disabled",
    },
+   {
+      "pcfx_rainbow_async",
+      "Asynchronous RAINBOW Decoding (Restart Required)",
+      NULL,
+      "Decode RAINBOW (motion JPEG) video blocks on a separate thread while emulation continues. Reduces CPU time on the emulation thread during FMV on multi-core devices. Output is unchanged.",
+      NULL,
+      NULL,
+      {
+         { "disabled", NULL },
+         { "enabled",  NULL },
+         { NULL, NULL},
+      },
+      "disabled",
+   },
+   {
+      "pcfx_rainbow_cache",
+      "RAINBOW Decoded Strip Cache (Restart Required)",
+      NULL,
+      "Keep recently decoded RAINBOW (motion JPEG) strips in memory, so that FMV which loops the same footage (title screens, attract mode) doesn't have to be decoded again. Stands down by itself when the footage doesn't repeat. Output is unchanged.",
+      NULL,
+      NULL,
+      {
+         { "0",  "disabled" },
+         { "8",  "8 MB" },
+         { "16", "16 MB" },
+         { "32", "32 MB" },
+         { "64", "64 MB" },
+         { NULL, NULL},
+      },
+      "0",
+   },
+   {
+      "pcfx_frame_pipelining",
+      "Frame Pipelining (Restart Required)",
+      NULL,
+      "Mix and color-convert each frame on a separate render thread while the next frame is being emulated. Gives more headroom on multi-core devices at the cost of one frame of additional input latency.",
+      NULL,
+      NULL,
+      {
+         { "disabled", NULL },
+         { "enabled",  NULL },
+         { NULL, NULL},
+      },
+      "disabled",
+   },
+#ifdef NEED_DEINTERLACER
+   {
+      "pcfx_deinterlacer",
+      "Deinterlacer",
+      NULL,
+      "Method used to fill in the missing lines of interlaced video. 'Weave' shows the previous field in them, 'Bob' repeats the line above, and 'Blend' averages the lines above and below.",
+      NULL,
+      NULL,
+      {
+         { "weave", "Weave" },
+         { "bob",   "Bob" },
+         { "blend", "Blend" },
+         { NULL, NULL},
+      },
+      "weave",
+   },
+#endif
    {
       "pcfxtreme_nospritelimit",
       "No Sprite Limit (Restart Required)",
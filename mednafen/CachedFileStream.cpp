@@ -0,0 +1,335 @@
+/* Mednafen - Multi-system Emulator
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <string.h>
+
+#include "mednafen.h"
+#include "Stream.h"
+#include "FileStream.h"
+#include "CachedFileStream.h"
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+
+#include <algorithm>
+#include <vector>
+
+enum { CHUNK_SIZE = 256 * 1024 };
+
+enum
+{
+ CHUNK_PENDING = 0,
+ CHUNK_LOADED,
+ CHUNK_FAILED	// Short read; left to go to the file.
+};
+
+//
+// One loader thread for all open streams, so that the files of a multi-file image are read one after another rather
+// than all at once.  Streams are only ever created and destroyed on the thread that opens and closes the disc image,
+// so the thread is started and stopped along with the first and last stream.
+//
+static slock_t *LoadLock = NULL;
+static scond_t *LoadCond = NULL;	// Signalled when there's loading to do.
+static scond_t *DoneCond = NULL;	// Broadcast when a chunk has been loaded.
+static sthread_t *LoadThread = NULL;
+static bool LoadDie;
+static std::vector<CachedFileStream *> Streams;
+static CachedFileStream *Busy;		// Stream being loaded into outside of the lock.
+
+void CachedFileStream::LoaderThread(void *arg)
+{
+ slock_lock(LoadLock);
+
+ while(!LoadDie)
+ {
+  CachedFileStream *s = NULL;
+  uint32 chunk = 0;
+
+  // Streams with a missed read first, then the rest in the order they were opened.
+  for(unsigned i = 0; i < Streams.size() && !s; i++)
+  {
+   if(Streams[i]->want_chunk >= 0)
+    s = Streams[i];
+  }
+
+  for(unsigned i = 0; i < Streams.size() && !s; i++)
+  {
+   if(Streams[i]->chunks_pending)
+    s = Streams[i];
+  }
+
+  if(!s)
+  {
+   scond_wait(LoadCond, LoadLock);
+   continue;
+  }
+
+  if(s->want_chunk >= 0)
+  {
+   s->load_cursor = s->want_chunk;
+   s->want_chunk = -1;
+  }
+
+  if(!s->chunks_pending)
+   continue;
+
+  chunk = s->load_cursor;
+  while(s->chunk_state[chunk] != CHUNK_PENDING)
+   chunk = (chunk + 1) % s->num_chunks;
+
+  {
+   const uint64 offset = (uint64)chunk * CHUNK_SIZE;
+   const uint64 len = std::min<uint64>(CHUNK_SIZE, s->data_size - offset);
+   uint64 got;
+
+   //
+   // Nothing reads this part of the buffer until the chunk is marked as loaded, so it can be filled in without the lock.
+   //
+   Busy = s;
+   slock_unlock(LoadLock);
+
+   s->load_file->seek(offset, SEEK_SET);
+   got = s->load_file->read(s->data + offset, len);
+
+   slock_lock(LoadLock);
+   Busy = NULL;
+
+   s->chunk_state[chunk] = (got == len) ? CHUNK_LOADED : CHUNK_FAILED;
+   s->chunks_pending--;
+   s->load_cursor = (chunk + 1) % s->num_chunks;
+
+   if(!s->chunks_pending)
+   {
+    s->complete = true;
+
+    for(uint32 i = 0; i < s->num_chunks; i++)
+    {
+     if(s->chunk_state[i] != CHUNK_LOADED)
+      s->complete = false;
+    }
+   }
+  }
+
+  scond_broadcast(DoneCond);
+ }
+
+ slock_unlock(LoadLock);
+}
+
+CachedFileStream::CachedFileStream(const char *path) : data(NULL), data_size(0), position(0), file(NULL), load_file(NULL), chunk_state(NULL),
+						       num_chunks(0), chunks_pending(0), load_cursor(0), want_chunk(-1), complete(false), mem_only(false)
+{
+ file = new FileStream(path, MODE_READ);
+ data_size = file->size();
+
+ if(!data_size || (int64)data_size < 0 || data_size > SIZE_MAX)
+  return;
+
+ if(!(data = (uint8 *)malloc(data_size)))
+  return;
+
+ num_chunks = (data_size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+ chunks_pending = num_chunks;
+ if(!(chunk_state = (uint8 *)calloc(num_chunks, 1)))
+ {
+  free(data);
+  data = NULL;
+  return;
+ }
+
+ load_file = new FileStream(path, MODE_READ);
+
+ if(Streams.empty())
+ {
+  LoadLock = slock_new();
+  LoadCond = scond_new();
+  DoneCond = scond_new();
+  LoadDie = false;
+  Busy = NULL;
+  LoadThread = sthread_create(LoaderThread, NULL);
+ }
+
+ slock_lock(LoadLock);
+ Streams.push_back(this);
+ scond_signal(LoadCond);
+ slock_unlock(LoadLock);
+}
+
+CachedFileStream::~CachedFileStream()
+{
+ close();
+}
+
+bool CachedFileStream::ok(void)
+{
+ return data != NULL;
+}
+
+uint64 CachedFileStream::read(void *dest, uint64 count)
+{
+ if(position < 0 || (uint64)position >= data_size)
+  return 0;
+
+ if(count > (data_size - position))
+  count = data_size - position;
+
+ if(!count)
+  return 0;
+
+ if(!mem_only)
+ {
+  const uint32 first = position / CHUNK_SIZE;
+  const uint32 last = (position + count - 1) / CHUNK_SIZE;
+  int64 missed = -1;
+
+  slock_lock(LoadLock);
+
+  mem_only = complete;
+
+  for(uint32 i = first; i <= last && missed < 0; i++)
+  {
+   if(chunk_state[i] != CHUNK_LOADED)
+    missed = i;
+  }
+
+  if(missed >= 0 && chunk_state[missed] == CHUNK_PENDING && want_chunk < 0)
+  {
+   want_chunk = missed;
+   scond_signal(LoadCond);
+  }
+
+  slock_unlock(LoadLock);
+
+  if(missed >= 0)
+  {
+   uint64 got;
+
+   file->seek(position, SEEK_SET);
+   got = file->read(dest, count);
+   position += got;
+
+   return got;
+  }
+ }
+
+ memcpy(dest, &data[position], count);
+ position += count;
+
+ return count;
+}
+
+void CachedFileStream::write(const void *dest, uint64 count)
+{
+
+}
+
+void CachedFileStream::seek(int64 offset, int whence)
+{
+ switch(whence)
+ {
+    case SEEK_SET:
+       position = offset;
+       break;
+
+    case SEEK_CUR:
+       position += offset;
+       break;
+
+    case SEEK_END:
+       position = data_size + offset;
+       break;
+ }
+}
+
+uint64_t CachedFileStream::tell(void)
+{
+ return position;
+}
+
+uint64_t CachedFileStream::size(void)
+{
+ return data_size;
+}
+
+void CachedFileStream::close(void)
+{
+ if(chunk_state)
+ {
+  bool last;
+
+  slock_lock(LoadLock);
+
+  while(Busy == this)
+   scond_wait(DoneCond, LoadLock);
+
+  Streams.erase(std::find(Streams.begin(), Streams.end(), this));
+  last = Streams.empty();
+
+  if(last)
+  {
+   LoadDie = true;
+   scond_signal(LoadCond);
+  }
+
+  slock_unlock(LoadLock);
+
+  if(last)
+  {
+   sthread_join(LoadThread);
+   LoadThread = NULL;
+
+   scond_free(DoneCond);
+   scond_free(LoadCond);
+   slock_free(LoadLock);
+   DoneCond = NULL;
+   LoadCond = NULL;
+   LoadLock = NULL;
+  }
+
+  free(chunk_state);
+  chunk_state = NULL;
+ }
+
+ if(load_file)
+ {
+  delete load_file;
+  load_file = NULL;
+ }
+
+ if(file)
+ {
+  delete file;
+  file = NULL;
+ }
+
+ if(data)
+ {
+  free(data);
+  data = NULL;
+ }
+
+ data_size = 0;
+}
+
+void CachedFileStream::truncate(uint64_t length)
+{
+}
+
+void CachedFileStream::flush(void)
+{
+}
+#endif
@@ -0,0 +1,76 @@
+/* Mednafen - Multi-system Emulator
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef __MDFN_CACHEDFILESTREAM_H
+#define __MDFN_CACHEDFILESTREAM_H
+
+#include "Stream.h"
+
+class FileStream;
+
+//
+// Read-only stream that copies a file into memory on a background thread, instead of all at once up front like
+// MemoryStream(Stream*) does.  Files are loaded one after another in the order they were opened, a chunk at a time from
+// the start of the file, except that a read of a chunk that isn't in memory yet moves loading over to it.  Such reads
+// go to the file meanwhile.  Once the whole file is in memory, it's read from memory only.
+//
+// ok() returns false if the file couldn't be opened or the memory couldn't be allocated, in which case the caller
+// should fall back to a FileStream.  Requires HAVE_THREADS.
+//
+class CachedFileStream : public Stream
+{
+ public:
+
+ CachedFileStream(const char *path);
+ virtual ~CachedFileStream();
+
+ bool ok(void);
+
+ virtual uint64 read(void *data, uint64 count);
+ virtual void write(const void *data, uint64 count);
+ virtual void seek(int64 offset, int whence);
+ virtual void truncate(uint64_t length);
+ virtual void flush(void);
+ virtual uint64_t tell(void);
+ virtual uint64_t size(void);
+ virtual void close(void);
+
+ private:
+
+ static void LoaderThread(void *arg);
+
+ uint8 *data;
+ uint64 data_size;
+ int64 position;
+
+ FileStream *file;		// For reads of what isn't loaded yet.
+ FileStream *load_file;		// Loader thread's own handle.
+
+ //
+ // Protected by the loader lock.
+ //
+ uint8 *chunk_state;		// CHUNK_* per chunk.
+ uint32 num_chunks;
+ uint32 chunks_pending;		// Chunks the loader hasn't gotten to yet.
+ uint32 load_cursor;		// Where the loader carries on from.
+ int64 want_chunk;		// Chunk a read missed, for the loader to do next; -1 if none.
+ bool complete;
+
+ bool mem_only;			// Reader-side copy of complete, so the lock can be skipped once it's set.
+};
+
+#endif
@@ -0,0 +1,217 @@
+/* Mednafen - Multi-system Emulator
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <string.h>
+#include <algorithm>
+
+#include "mednafen.h"
+#include "Stream.h"
+#include "MappedFileStream.h"
+
+// Same platform split as libretro-common's memmap.h.
+#if defined(PSP) || defined(PS2) || defined(GEKKO) || defined(VITA) || defined(_XBOX) || defined(_3DS) || defined(WIIU) || defined(SWITCH) || defined(HAVE_LIBNX) || defined(__PS3__) || defined(__PSL1GHT__)
+/* No mman available */
+#elif defined(_WIN32)
+#include <windows.h>
+#include <encodings/utf.h>
+#define MAPPEDFILESTREAM_WIN32
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define MAPPEDFILESTREAM_MMAN
+#endif
+
+//
+// How far ahead of the read position the OS is asked to read pages in, and how much of that has to be left before asking
+// again.  About 2 seconds of sectors at 1x speed.
+//
+enum { READAHEAD_SIZE = 2352 * 150 };
+enum { READAHEAD_REFRESH = READAHEAD_SIZE / 2 };
+
+MappedFileStream::MappedFileStream(const char *path) : data(NULL), data_size(0), position(0), ra_start(0), ra_end(0)
+{
+#if defined(_WIN32)
+ map_handle = NULL;
+#endif
+
+#if defined(MAPPEDFILESTREAM_MMAN)
+ int fd = open(path, O_RDONLY);
+ struct stat st;
+
+ if(fd < 0)
+  return;
+
+ if(!fstat(fd, &st) && S_ISREG(st.st_mode) && st.st_size > 0 && (uint64)st.st_size <= SIZE_MAX)
+ {
+  void *p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+  if(p != MAP_FAILED)
+  {
+   data = (uint8 *)p;
+   data_size = st.st_size;
+  }
+ }
+
+ // The mapping keeps its own reference to the file.
+ ::close(fd);
+#elif defined(MAPPEDFILESTREAM_WIN32)
+ wchar_t *path_w = utf8_to_utf16_string_alloc(path);
+ HANDLE fh;
+ LARGE_INTEGER fs;
+
+ if(!path_w)
+  return;
+
+ fh = CreateFileW(path_w, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+ free(path_w);
+
+ if(fh == INVALID_HANDLE_VALUE)
+  return;
+
+ if(GetFileSizeEx(fh, &fs) && fs.QuadPart > 0 && (uint64)fs.QuadPart <= SIZE_MAX)
+ {
+  map_handle = CreateFileMappingW(fh, NULL, PAGE_READONLY, 0, 0, NULL);
+
+  if(map_handle)
+  {
+   data = (uint8 *)MapViewOfFile(map_handle, FILE_MAP_READ, 0, 0, 0);
+
+   if(data)
+    data_size = fs.QuadPart;
+   else
+   {
+    CloseHandle(map_handle);
+    map_handle = NULL;
+   }
+  }
+ }
+
+ CloseHandle(fh);
+#endif
+}
+
+MappedFileStream::~MappedFileStream()
+{
+ close();
+}
+
+uint8 *MappedFileStream::map(void)
+{
+ return data;
+}
+
+void MappedFileStream::unmap(void)
+{
+
+}
+
+//
+// Asks the OS to start reading in the pages after the read position, if it hasn't been asked to already, so that the
+// reads themselves don't stall on page faults.  The page cache takes care of this by itself under Windows.
+//
+INLINE void MappedFileStream::readahead(void)
+{
+#if defined(MAPPEDFILESTREAM_MMAN) && defined(MADV_WILLNEED)
+ if((uint64)position < ra_start || ((uint64)position + READAHEAD_REFRESH) > ra_end)
+ {
+  const uint64 page_mask = (uint64)sysconf(_SC_PAGESIZE) - 1;
+  const uint64 start = (uint64)position & ~page_mask;
+  const uint64 end = std::min<uint64>((uint64)position + READAHEAD_SIZE, data_size);
+
+  if(start < end)
+   madvise(data + start, end - start, MADV_WILLNEED);
+
+  ra_start = start;
+  ra_end = (uint64)position + READAHEAD_SIZE;
+ }
+#endif
+}
+
+uint64 MappedFileStream::read(void *dest, uint64 count)
+{
+ if(position < 0 || (uint64)position >= data_size)
+  return 0;
+
+ if(count > (data_size - position))
+  count = data_size - position;
+
+ readahead();
+
+ memcpy(dest, &data[position], count);
+ position += count;
+
+ return count;
+}
+
+void MappedFileStream::write(const void *dest, uint64 count)
+{
+
+}
+
+void MappedFileStream::seek(int64 offset, int whence)
+{
+ switch(whence)
+ {
+    case SEEK_SET:
+       position = offset;
+       break;
+
+    case SEEK_CUR:
+       position += offset;
+       break;
+
+    case SEEK_END:
+       position = data_size + offset;
+       break;
+ }
+}
+
+uint64_t MappedFileStream::tell(void)
+{
+ return position;
+}
+
+uint64_t MappedFileStream::size(void)
+{
+ return data_size;
+}
+
+void MappedFileStream::close(void)
+{
+ if(data)
+ {
+#if defined(MAPPEDFILESTREAM_MMAN)
+  munmap(data, data_size);
+#elif defined(MAPPEDFILESTREAM_WIN32)
+  UnmapViewOfFile(data);
+  CloseHandle(map_handle);
+  map_handle = NULL;
+#endif
+  data = NULL;
+  data_size = 0;
+ }
+}
+
+void MappedFileStream::truncate(uint64_t length)
+{
+}
+
+void MappedFileStream::flush(void)
+{
+}
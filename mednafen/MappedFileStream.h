@@ -0,0 +1,65 @@
+/* Mednafen - Multi-system Emulator
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef __MDFN_MAPPEDFILESTREAM_H
+#define __MDFN_MAPPEDFILESTREAM_H
+
+#include "Stream.h"
+
+//
+// Read-only stream over a file mapped into memory(mmap() or MapViewOfFile()), so that reads are plain memory copies
+// instead of system calls, and the data isn't held in memory twice(page cache + a copy) like with MemoryStream.
+//
+// map() returns NULL if the file couldn't be mapped(not supported on the platform, not a regular file, empty, etc.),
+// in which case the caller should fall back to a FileStream.
+//
+class MappedFileStream : public Stream
+{
+ public:
+
+ MappedFileStream(const char *path);
+ virtual ~MappedFileStream();
+
+ virtual uint8 *map(void);
+ virtual void unmap(void);
+
+ virtual uint64 read(void *data, uint64 count);
+ virtual void write(const void *data, uint64 count);
+ virtual void seek(int64 offset, int whence);
+ virtual void truncate(uint64_t length);
+ virtual void flush(void);
+ virtual uint64_t tell(void);
+ virtual uint64_t size(void);
+ virtual void close(void);
+
+ private:
+
+ void readahead(void);
+
+ uint8 *data;
+ uint64 data_size;
+ int64 position;
+
+ uint64 ra_start;	// Range last asked to be read in ahead of time.
+ uint64 ra_end;
+
+#if defined(_WIN32)
+ void *map_handle;
+#endif
+};
+
+#endif
@@ -28,6 +28,10 @@
 #include <mednafen/mednafen.h>
 #include "CDAFReader.h"
 #include "CDAFReader_Vorbis.h"
+#ifdef HAVE_CHD
+#include "CDAFReader_FLAC.h"
+#endif
+#include "CDAFReader_Buffered.h"
 #ifdef HAVE_MPC
 #include "CDAFReader_MPC.h"
 #endif
@@ -42,12 +46,32 @@ CDAFReader::~CDAFReader()
 
 }
 
+void CDAFReader::Hint(uint64_t frame_offset)
+{
+
+}
+
 CDAFReader* CDAFR_Open(Stream* fp)
 {
+#ifdef HAVE_CHD
+  // FLAC is told apart by its stream marker; everything else goes on to the Vorbis(or MPC) reader like before.
+  {
+   uint8 magic[4];
+   bool is_flac;
+
+   fp->seek(0, SEEK_SET);
+   is_flac = (fp->read(magic, 4) == 4 && !memcmp(magic, "fLaC", 4));
+   fp->seek(0, SEEK_SET);
+
+   if(is_flac)
+    return CDAFR_Buffered_Open(CDAFR_FLAC_Open(fp));
+  }
+#endif
+
 #ifdef HAVE_MPC
-  return CDAFR_MPC_Open(fp);
+  return CDAFR_Buffered_Open(CDAFR_MPC_Open(fp));
 #else
-  return CDAFR_Vorbis_Open(fp);
+  return CDAFR_Buffered_Open(CDAFR_Vorbis_Open(fp));
 #endif
 }
 
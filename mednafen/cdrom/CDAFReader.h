@@ -31,6 +31,10 @@ class CDAFReader
  virtual ~CDAFReader();
 
  virtual uint64_t FrameCount(void) = 0;
+
+ // Lets the reader know that reading will likely start from frame_offset soon.  Safe to call from a different thread
+ // than the one doing the reading.
+ virtual void Hint(uint64_t frame_offset);
  INLINE uint64_t Read(uint64_t frame_offset, int16 *buffer, uint64_t frames)
  {
   uint64_t ret;
@@ -0,0 +1,380 @@
+/******************************************************************************/
+/* Mednafen - Multi-system Emulator                                           */
+/******************************************************************************/
+/* CDAFReader_Buffered.cpp:
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software Foundation, Inc.,
+** 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+//
+// Compressed CD-DA tracks are decoded ahead of where they're being read from by one worker thread shared by all open
+// readers, into a ring buffer per reader.  A reader's buffer holds a window of consecutive frames that starts a little
+// before the last read position; reading from, or hinting at, a position outside of the window restarts it there.
+//
+// Once a reader has been handed over, only the worker thread touches it.
+//
+
+#include <mednafen/mednafen.h>
+#include "CDAFReader.h"
+#include "CDAFReader_Buffered.h"
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+
+#include <algorithm>
+#include <vector>
+
+enum { BUF_FRAMES = 588 * 75 * 3 };		// 3 seconds
+enum { KEEP_BEHIND_FRAMES = 588 * 8 };		// Kept behind the read position, for sectors that get read again.
+enum { DECODE_CHUNK_FRAMES = 588 * 4 };
+enum { MAX_BUFFERS = 4 };			// Readers with a buffer at once; the least recently used one loses its buffer.
+enum { MAX_READ_FRAMES = BUF_FRAMES - KEEP_BEHIND_FRAMES - DECODE_CHUNK_FRAMES };	// Most frames one Read_() returns.
+
+class CDAFReader_Buffered : public CDAFReader
+{
+   public:
+      CDAFReader_Buffered(CDAFReader *arg_source);
+      ~CDAFReader_Buffered();
+
+      uint64_t Read_(int16_t *buffer, uint64_t frames);
+      bool Seek_(uint64_t frame_offset);
+      uint64_t FrameCount(void);
+      void Hint(uint64_t frame_offset);
+
+   private:
+      static void WorkerThread(void *arg);
+
+      void Touch(void);
+      void Restart(uint64_t frame_offset);
+      void DropBehind(void);
+
+      CDAFReader *Source;
+      uint64_t SourceFrameCount;
+
+      int16_t *Buf;		// BUF_FRAMES stereo frames, indexed by frame offset modulo BUF_FRAMES; NULL until used(or if it couldn't be allocated).
+      uint64_t BufStart;	// Frame offset of the first frame in the window.
+      uint64_t BufFill;		// Frames in the window.
+      bool BufEOF;		// Source ran out at BufStart + BufFill.
+      uint32_t Generation;	// Bumped when the window is restarted or dropped, so that in-flight decodes are thrown away.
+      uint64_t LastUsed;
+
+      uint64_t ReadPos;
+};
+
+//
+// Shared between all readers, and protected by WorkLock.  Readers are only ever created and destroyed on the thread that
+// opens and closes the disc image, so starting and stopping the worker thread with the first and last reader is safe.
+//
+static slock_t *WorkLock = NULL;
+static scond_t *WorkCond = NULL;	// Signalled when there may be decoding to do.
+static scond_t *DataCond = NULL;	// Broadcast when the worker thread has finished decoding a chunk.
+static sthread_t *WorkThread = NULL;
+static bool WorkDie;
+static std::vector<CDAFReader_Buffered *> Readers;
+static CDAFReader_Buffered *Busy;	// Reader being decoded from outside of the lock.
+static uint64_t UseCounter;
+static unsigned BufCount;
+
+void CDAFReader_Buffered::WorkerThread(void *arg)
+{
+   int16_t tmp[DECODE_CHUNK_FRAMES * 2];
+
+   slock_lock(WorkLock);
+
+   while(!WorkDie)
+   {
+      CDAFReader_Buffered *r = NULL;
+
+      // The most recently used reader with room left comes first, which is normally the one being played.
+      for(unsigned i = 0; i < Readers.size(); i++)
+      {
+         CDAFReader_Buffered *c = Readers[i];
+
+         if(c->Buf && !c->BufEOF && (c->BufFill + DECODE_CHUNK_FRAMES) <= BUF_FRAMES && (!r || c->LastUsed > r->LastUsed))
+            r = c;
+      }
+
+      if(!r)
+      {
+         scond_wait(WorkCond, WorkLock);
+         continue;
+      }
+
+      {
+         const uint64_t pos = r->BufStart + r->BufFill;
+         const uint32_t gen = r->Generation;
+         uint64_t got;
+
+         Busy = r;
+         slock_unlock(WorkLock);
+
+         got = r->Source->Read(pos, tmp, DECODE_CHUNK_FRAMES);
+
+         slock_lock(WorkLock);
+         Busy = NULL;
+
+         if(r->Generation == gen)
+         {
+            for(uint64_t done = 0; done < got; )
+            {
+               const uint64_t idx = (pos + done) % BUF_FRAMES;
+               const uint64_t n = std::min<uint64_t>(got - done, BUF_FRAMES - idx);
+
+               memcpy(&r->Buf[idx * 2], &tmp[done * 2], n * 2 * sizeof(int16_t));
+               done += n;
+            }
+
+            r->BufFill += got;
+
+            if(got < DECODE_CHUNK_FRAMES)
+               r->BufEOF = true;
+         }
+
+         scond_broadcast(DataCond);
+      }
+   }
+
+   slock_unlock(WorkLock);
+}
+
+CDAFReader_Buffered::CDAFReader_Buffered(CDAFReader *arg_source) : Source(arg_source), Buf(NULL), BufStart(0), BufFill(0), BufEOF(false),
+								   Generation(0), LastUsed(0), ReadPos(0)
+{
+   SourceFrameCount = Source->FrameCount();
+
+   if(Readers.empty())
+   {
+      WorkLock = slock_new();
+      WorkCond = scond_new();
+      DataCond = scond_new();
+      WorkDie = false;
+      Busy = NULL;
+      WorkThread = sthread_create(WorkerThread, NULL);
+   }
+
+   slock_lock(WorkLock);
+   Readers.push_back(this);
+   slock_unlock(WorkLock);
+}
+
+CDAFReader_Buffered::~CDAFReader_Buffered()
+{
+   bool last;
+
+   slock_lock(WorkLock);
+
+   while(Busy == this)
+      scond_wait(DataCond, WorkLock);
+
+   Readers.erase(std::find(Readers.begin(), Readers.end(), this));
+
+   if(Buf)
+   {
+      free(Buf);
+      Buf = NULL;
+      BufCount--;
+   }
+
+   last = Readers.empty();
+
+   if(last)
+   {
+      WorkDie = true;
+      scond_signal(WorkCond);
+   }
+
+   slock_unlock(WorkLock);
+
+   if(last)
+   {
+      sthread_join(WorkThread);
+      WorkThread = NULL;
+
+      scond_free(DataCond);
+      scond_free(WorkCond);
+      slock_free(WorkLock);
+      DataCond = NULL;
+      WorkCond = NULL;
+      WorkLock = NULL;
+   }
+
+   delete Source;
+}
+
+// Called with WorkLock held.
+void CDAFReader_Buffered::Touch(void)
+{
+   LastUsed = ++UseCounter;
+
+   if(Buf)
+      return;
+
+   if(BufCount >= MAX_BUFFERS)
+   {
+      CDAFReader_Buffered *lru = NULL;
+
+      for(unsigned i = 0; i < Readers.size(); i++)
+      {
+         CDAFReader_Buffered *c = Readers[i];
+
+         if(c != this && c->Buf && (!lru || c->LastUsed < lru->LastUsed))
+            lru = c;
+      }
+
+      if(lru)
+      {
+         free(lru->Buf);
+         lru->Buf = NULL;
+         lru->BufFill = 0;
+         lru->BufEOF = false;
+         lru->Generation++;
+         BufCount--;
+      }
+   }
+
+   // Without a buffer, Read_() reads straight from the source.
+   if(!(Buf = (int16_t *)malloc(BUF_FRAMES * 2 * sizeof(int16_t))))
+      return;
+
+   BufCount++;
+   Restart(ReadPos);
+}
+
+// Called with WorkLock held.
+void CDAFReader_Buffered::Restart(uint64_t frame_offset)
+{
+   BufStart = frame_offset;
+   BufFill = 0;
+   BufEOF = (frame_offset >= SourceFrameCount);
+   Generation++;
+
+   scond_signal(WorkCond);
+}
+
+// Called with WorkLock held, and ReadPos in the window.  Drops what's more than KEEP_BEHIND_FRAMES behind the read position
+// from the window, making room for the worker thread to decode more.
+void CDAFReader_Buffered::DropBehind(void)
+{
+   if((ReadPos - BufStart) > KEEP_BEHIND_FRAMES)
+   {
+      const uint64_t drop = ReadPos - KEEP_BEHIND_FRAMES - BufStart;
+
+      BufStart += drop;
+      BufFill -= drop;
+      scond_signal(WorkCond);
+   }
+}
+
+uint64_t CDAFReader_Buffered::Read_(int16_t *buffer, uint64_t frames)
+{
+   uint64_t ret;
+
+   // Far more than the sector's worth at a time that's normally read; with at most this much, the window always has room for
+   // the whole read once what's behind the read position has been dropped.
+   frames = std::min<uint64_t>(frames, MAX_READ_FRAMES);
+
+   slock_lock(WorkLock);
+
+   for(;;)
+   {
+      // Done every time around, as a hint from another thread may have taken the buffer away in the meantime.
+      Touch();
+
+      if(!Buf)
+      {
+         // The worker thread may still be decoding from the source, from before the buffer was taken away.
+         while(Busy == this)
+            scond_wait(DataCond, WorkLock);
+
+         ret = Source->Read(ReadPos, buffer, frames);
+         ReadPos += ret;
+
+         slock_unlock(WorkLock);
+
+         return(ret);
+      }
+
+      if(ReadPos < BufStart || ReadPos > (BufStart + BufFill))
+         Restart(ReadPos);
+
+      if((BufStart + BufFill) >= (ReadPos + frames) || BufEOF)
+         break;
+
+      // The window may be full with the read running past its end.
+      DropBehind();
+
+      scond_signal(WorkCond);
+      scond_wait(DataCond, WorkLock);
+   }
+
+   ret = std::min<uint64_t>(frames, BufStart + BufFill - ReadPos);
+
+   for(uint64_t done = 0; done < ret; )
+   {
+      const uint64_t idx = (ReadPos + done) % BUF_FRAMES;
+      const uint64_t n = std::min<uint64_t>(ret - done, BUF_FRAMES - idx);
+
+      memcpy(&buffer[done * 2], &Buf[idx * 2], n * 2 * sizeof(int16_t));
+      done += n;
+   }
+
+   ReadPos += ret;
+   DropBehind();
+
+   slock_unlock(WorkLock);
+
+   return(ret);
+}
+
+bool CDAFReader_Buffered::Seek_(uint64_t frame_offset)
+{
+   // Hint() may be using it from another thread.
+   slock_lock(WorkLock);
+   ReadPos = frame_offset;
+   slock_unlock(WorkLock);
+
+   return(true);
+}
+
+uint64_t CDAFReader_Buffered::FrameCount(void)
+{
+   return(SourceFrameCount);
+}
+
+void CDAFReader_Buffered::Hint(uint64_t frame_offset)
+{
+   slock_lock(WorkLock);
+
+   Touch();
+
+   if(frame_offset < BufStart || frame_offset > (BufStart + BufFill))
+      Restart(frame_offset);
+
+   slock_unlock(WorkLock);
+}
+
+CDAFReader* CDAFR_Buffered_Open(CDAFReader* source)
+{
+   if(!source)
+      return(NULL);
+
+   return new CDAFReader_Buffered(source);
+}
+#else
+CDAFReader* CDAFR_Buffered_Open(CDAFReader* source)
+{
+   return(source);
+}
+#endif
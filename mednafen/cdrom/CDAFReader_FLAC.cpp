@@ -0,0 +1,109 @@
+/******************************************************************************/
+/* Mednafen - Multi-system Emulator                                           */
+/******************************************************************************/
+/* CDAFReader_FLAC.cpp:
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software Foundation, Inc.,
+** 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+// Uses the dr_flac that's built as part of libchdr(see libchdr_flac.c for the implementation).  Seeking goes through the
+// stream's SEEKTABLE when it has one, and is sample-accurate either way.
+
+#include <mednafen/mednafen.h>
+#include "CDAFReader.h"
+#include "CDAFReader_FLAC.h"
+
+#include <dr_libs/dr_flac.h>
+
+class CDAFReader_FLAC : public CDAFReader
+{
+   public:
+      CDAFReader_FLAC(drflac *arg_dfl);
+      ~CDAFReader_FLAC();
+
+      uint64_t Read_(int16_t *buffer, uint64_t frames);
+      bool Seek_(uint64_t frame_offset);
+      uint64_t FrameCount(void);
+
+   private:
+      drflac *dfl;
+};
+
+
+static size_t dfl_read_func(void *user_data, void *buffer, size_t bytes)
+{
+   Stream *fw = (Stream*)user_data;
+   int64_t didread = fw->read(buffer, bytes);
+
+   if(didread < 0)
+      return(0);
+
+   return(didread);
+}
+
+static drflac_bool32 dfl_seek_func(void *user_data, int offset, drflac_seek_origin origin)
+{
+   Stream *fw = (Stream*)user_data;
+   const int64_t base = (origin == drflac_seek_origin_start) ? 0 : (int64_t)fw->tell();
+
+   // dr_flac relies on seeks past the end failing.
+   if((base + offset) < 0 || (uint64_t)(base + offset) > fw->size())
+      return(DRFLAC_FALSE);
+
+   fw->seek(base + offset, SEEK_SET);
+   return(DRFLAC_TRUE);
+}
+
+CDAFReader_FLAC::CDAFReader_FLAC(drflac *arg_dfl) : dfl(arg_dfl)
+{
+
+}
+
+CDAFReader_FLAC::~CDAFReader_FLAC()
+{
+   drflac_close(dfl);
+}
+
+uint64_t CDAFReader_FLAC::Read_(int16_t *buffer, uint64_t frames)
+{
+   return(drflac_read_pcm_frames_s16(dfl, frames, buffer));
+}
+
+bool CDAFReader_FLAC::Seek_(uint64_t frame_offset)
+{
+   return(drflac_seek_to_pcm_frame(dfl, frame_offset));
+}
+
+uint64_t CDAFReader_FLAC::FrameCount(void)
+{
+   return(dfl->totalPCMFrameCount);
+}
+
+CDAFReader* CDAFR_FLAC_Open(Stream* fp)
+{
+   drflac *dfl = drflac_open(dfl_read_func, dfl_seek_func, fp, NULL);
+
+   if(!dfl)
+      return(NULL);
+
+   if(dfl->channels != 2)
+   {
+      log_cb(RETRO_LOG_ERROR, "FLAC audio track has %u channels, only stereo is supported.\n", (unsigned)dfl->channels);
+      drflac_close(dfl);
+      return(NULL);
+   }
+
+   return new CDAFReader_FLAC(dfl);
+}
@@ -16,6 +16,10 @@
  */
 
 #include "../mednafen.h"
+#include "../FileStream.h"
+#include "../MemoryStream.h"
+#include "../MappedFileStream.h"
+#include "../CachedFileStream.h"
 #include "CDAccess.h"
 #include "CDAccess_Image.h"
 #include "CDAccess_CCD.h"
@@ -33,19 +37,60 @@ CDAccess::~CDAccess()
 
 }
 
-CDAccess* CDAccess_Open(const std::string& path, bool image_memcache)
+void CDAccess::Hint_Audio_Play(int32_t lba)
+{
+
+}
+
+bool CDAccess::Is_Fully_Cached(void)
+{
+   return false;
+}
+
+CDAccess* CDAccess_Open(const std::string& path, unsigned image_cache)
 {
    CDAccess *ret = NULL;
 
    if(path.size() >= 4 && !strcasecmp(path.c_str() + path.size() - 4, ".ccd"))
-      ret = new CDAccess_CCD(path, image_memcache);
+      ret = new CDAccess_CCD(path, image_cache);
 #ifdef HAVE_CHD
    else if(path.size() >= 4 && !strcasecmp(path.c_str() + path.size() - 4, ".chd"))
-      ret = new CDAccess_CHD(path, image_memcache);
+      ret = new CDAccess_CHD(path, image_cache);
 #endif
    else
-      ret = new CDAccess_Image(path, image_memcache);
+      ret = new CDAccess_Image(path, image_cache);
 
    return ret;
 }
 
+Stream* CDAccess_OpenImageFile(const std::string& path, unsigned image_cache)
+{
+   if(image_cache == CDACCESS_IMAGE_MMAP)
+   {
+      MappedFileStream *ms = new MappedFileStream(path.c_str());
+
+      if(ms->map())
+         return ms;
+
+      // Not something that can be mapped(or not on this platform), so just read it as a file.
+      delete ms;
+   }
+
+   if(image_cache == CDACCESS_IMAGE_MEMCACHE || image_cache == CDACCESS_IMAGE_DECOMPRESS)
+   {
+#ifdef HAVE_THREADS
+      // Loaded in the background, so the game can start before the whole image has been read in.
+      CachedFileStream *cs = new CachedFileStream(path.c_str());
+
+      if(cs->ok())
+         return cs;
+
+      delete cs;
+#else
+      return new MemoryStream(new FileStream(path.c_str(), MODE_READ));
+#endif
+   }
+
+   return new FileStream(path.c_str(), MODE_READ);
+}
+
@@ -5,6 +5,17 @@
 
 #include "CDUtility.h"
 
+class Stream;
+
+// How the disc image's files are read.
+enum
+{
+ CDACCESS_IMAGE_STREAM = 0,	// Read from the files as sectors are needed.
+ CDACCESS_IMAGE_MEMCACHE,	// Loaded into memory in full(in the background on threaded builds).
+ CDACCESS_IMAGE_MMAP,		// Mapped into memory, with the OS paging the data in as it's needed.
+ CDACCESS_IMAGE_DECOMPRESS	// As MEMCACHE, except that CHD images are decompressed in full when the image is opened.
+};
+
 class CDAccess
 {
  public:
@@ -22,11 +33,22 @@ class CDAccess
 
  virtual bool Read_TOC(TOC *toc) = 0;
 
+ // Called when CD-DA playback is about to start at lba, so that audio which is slow to get at can be readied ahead of time.
+ // Must be safe to call from any thread, concurrently with reads.
+ virtual void Hint_Audio_Play(int32_t lba);
+
+ // Returns true if the whole image is already in memory, in the form sectors are read from, so that reading never has to
+ // wait on I/O or decompression.
+ virtual bool Is_Fully_Cached(void);
+
  private:
  CDAccess(const CDAccess&);	// No copy constructor.
  CDAccess& operator=(const CDAccess&); // No assignment operator.
 };
 
-CDAccess* CDAccess_Open(const std::string& path, bool image_memcache);
+CDAccess* CDAccess_Open(const std::string& path, unsigned image_cache);
+
+// Opens one of the disc image's(non-descriptor) files the way image_cache says to.
+Stream* CDAccess_OpenImageFile(const std::string& path, unsigned image_cache);
 
 #endif
@@ -72,12 +72,12 @@ static T CCD_ReadInt(CCD_Section &s, const std::string &propname, const bool hav
 }
 
 
-CDAccess_CCD::CDAccess_CCD(const std::string& path, bool image_memcache) : img_numsectors(0)
+CDAccess_CCD::CDAccess_CCD(const std::string& path, unsigned image_cache) : img_numsectors(0)
 {
-   Load(path, image_memcache);
+   Load(path, image_cache);
 }
 
-bool CDAccess_CCD::Load(const std::string& path, bool image_memcache)
+bool CDAccess_CCD::Load(const std::string& path, unsigned image_cache)
 {
    FileStream cf(path.c_str(), MODE_READ);
    std::map<std::string, CCD_Section> Sections;
@@ -248,10 +248,7 @@ bool CDAccess_CCD::Load(const std::string& path, bool image_memcache)
    {
       std::string image_path = MDFN_EvalFIP(dir_path, file_base + std::string(".") + std::string(img_extsd), true);
 
-      if(image_memcache)
-         img_stream = new MemoryStream(new FileStream(image_path.c_str(), MODE_READ));
-      else
-         img_stream = new FileStream(image_path.c_str(), MODE_READ);
+      img_stream = CDAccess_OpenImageFile(image_path, image_cache);
 
       uint64 ss = img_stream->size();
 
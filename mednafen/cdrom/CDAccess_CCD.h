@@ -28,7 +28,7 @@ class CDAccess_CCD : public CDAccess
 {
  public:
 
- CDAccess_CCD(const std::string& path, bool image_memcache);
+ CDAccess_CCD(const std::string& path, unsigned image_cache);
  virtual ~CDAccess_CCD();
 
  virtual bool Read_Raw_Sector(uint8 *buf, int32 lba);
@@ -39,7 +39,7 @@ class CDAccess_CCD : public CDAccess
 
  private:
 
- bool Load(const std::string& path, bool image_memcache);
+ bool Load(const std::string& path, unsigned image_cache);
  void Cleanup(void);
 
  bool CheckSubQSanity(void);
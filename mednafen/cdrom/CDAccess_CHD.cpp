@@ -21,6 +21,14 @@
 
 #include <assert.h>
 
+#include <algorithm>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
 #include <mednafen/mednafen.h>
 #include <mednafen/general.h>
 #include <mednafen/mednafen-endian.h>
@@ -54,12 +62,152 @@ static const int32_t DI_Size_Table[8] =
         2352  // CD-I RAW
 };
 
-CDAccess_CHD::CDAccess_CHD(const std::string &path, bool image_memcache) : NumTracks(0), total_sectors(0)
+#ifdef HAVE_THREADS
+enum { NUM_PREFETCH_WORKERS = 2 };
+
+//
+// libchdr keeps decompression state in the chd_file, so each worker decompresses through its own handle to the image.
+//
+struct PrefetchWorker
+{
+  CDAccess_CHD *owner;
+  chd_file *chd;
+  sthread_t *thread;
+
+  static void Run(void *arg);
+};
+
+void PrefetchWorker::Run(void *arg)
+{
+  PrefetchWorker *w = (PrefetchWorker *)arg;
+  CDAccess_CHD *c = w->owner;
+
+  slock_lock(c->prefetch_lock);
+
+  while (!c->prefetch_die)
+  {
+    uint32_t hunknum;
+    int slot;
+    chd_error err;
+
+    if (c->prefetch_queue.empty())
+    {
+      scond_wait(c->prefetch_cond, c->prefetch_lock);
+      continue;
+    }
+
+    hunknum = c->prefetch_queue.front();
+    c->prefetch_queue.pop_front();
+
+    if (c->Find_Hunk_Slot(hunknum) >= 0 || (slot = c->Claim_Hunk_Slot()) < 0)
+      continue;
+
+    c->hunk_cache[slot].hunknum = hunknum;
+    c->hunk_cache[slot].busy = true;
+    slock_unlock(c->prefetch_lock);
+
+    err = chd_read(w->chd, hunknum, c->hunk_cache[slot].data);
+
+    slock_lock(c->prefetch_lock);
+    c->hunk_cache[slot].busy = false;
+
+    if (err != CHDERR_NONE)
+      c->hunk_cache[slot].hunknum = -1;
+    else
+      c->hunk_cache[slot].last_used = ++c->hunk_use_counter;
+
+    scond_broadcast(c->done_cond);
+  }
+
+  slock_unlock(c->prefetch_lock);
+}
+#endif
+
+//
+// Full decompression for CDACCESS_IMAGE_DECOMPRESS.  Worker threads(one per core) take batches of hunks to decompress
+// from the front of the image, each through its own handle.
+//
+enum { DECOMPRESS_BATCH_HUNKS = 64 };
+enum { MAX_DECOMPRESS_THREADS = 32 };
+
+struct DecompressJob
+{
+  const char *path;
+  uint32_t total_hunks;
+  uint32_t hunk_bytes;
+  uint8_t *dest;
+
+#ifdef HAVE_THREADS
+  slock_t *lock;
+  scond_t *cond;	/* signalled when a batch is done, and when a worker exits */
+  unsigned running;
+#endif
+  uint32_t next_hunk;
+  uint32_t hunks_done;
+  bool failed;
+};
+
+#ifdef HAVE_THREADS
+static unsigned GetCoreCount(void)
 {
-  Load(path, image_memcache);
+#if defined(_WIN32)
+  SYSTEM_INFO si;
+
+  GetSystemInfo(&si);
+  return si.dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+  const long n = sysconf(_SC_NPROCESSORS_ONLN);
+
+  return (n > 0) ? n : 1;
+#else
+  return 1;
+#endif
 }
 
-bool CDAccess_CHD::Load(const std::string &path, bool image_memcache)
+static void DecompressWorker(void *arg)
+{
+  DecompressJob *job = (DecompressJob *)arg;
+  chd_file *chd = NULL;
+  bool failed = (chd_open(job->path, CHD_OPEN_READ, NULL, &chd) != CHDERR_NONE);
+
+  slock_lock(job->lock);
+
+  while (!failed && !job->failed && job->next_hunk < job->total_hunks)
+  {
+    const uint32_t first = job->next_hunk;
+    const uint32_t count = std::min<uint32_t>(DECOMPRESS_BATCH_HUNKS, job->total_hunks - first);
+
+    job->next_hunk += count;
+    slock_unlock(job->lock);
+
+    for (uint32_t i = first; i < (first + count) && !failed; i++)
+      failed = (chd_read(chd, i, job->dest + (uint64_t)i * job->hunk_bytes) != CHDERR_NONE);
+
+    slock_lock(job->lock);
+    job->hunks_done += count;
+    scond_signal(job->cond);
+  }
+
+  if (failed)
+    job->failed = true;
+
+  job->running--;
+  scond_signal(job->cond);
+  slock_unlock(job->lock);
+
+  if (chd)
+    chd_close(chd);
+}
+#endif
+
+CDAccess_CHD::CDAccess_CHD(const std::string &path, unsigned image_cache) : NumTracks(0), total_sectors(0), chd(NULL), hunk_flat(NULL), hunk_use_counter(0), last_hunk(-1),
+                                                                             prefetch_hunks(0), prefetch_workers(NULL), num_prefetch_workers(0), prefetch_started(false),
+                                                                             prefetch_die(false), prefetch_lock(NULL), prefetch_cond(NULL), done_cond(NULL)
+{
+  Load(path, image_cache);
+}
+
+bool CDAccess_CHD::Load(const std::string &path, unsigned image_cache)
 {
   chd_error err = chd_open(path.c_str(), CHD_OPEN_READ, NULL, &chd);
   if (err != CHDERR_NONE)
@@ -68,7 +216,7 @@ bool CDAccess_CHD::Load(const std::string &path, bool image_memcache)
      return false;
   }
 
-  if (image_memcache)
+  if (image_cache == CDACCESS_IMAGE_MEMCACHE)
   {
      err = chd_precache(chd);
 
@@ -79,10 +227,38 @@ bool CDAccess_CHD::Load(const std::string &path, bool image_memcache)
      }
   }
 
+  chd_path = path;
+
+  if (image_cache == CDACCESS_IMAGE_DECOMPRESS)
+     Decompress_All();
+
   /* allocate storage for sector reads */
   const chd_header *head = chd_get_header(chd);
-  hunkmem = (uint8_t *)malloc(head->hunkbytes);
-  oldhunk = -1;
+  unsigned cache_hunks = hunk_flat ? 1 : MDFN_GetSettingUI("pcfx.chd.hunk_cache");
+
+#ifdef HAVE_THREADS
+  prefetch_hunks = hunk_flat ? 0 : MDFN_GetSettingUI("pcfx.chd.prefetch");
+
+  if (prefetch_hunks)
+  {
+     /* room for the hunk being read, and every hunk prefetched ahead of it */
+     cache_hunks = std::max<unsigned>(cache_hunks, prefetch_hunks + NUM_PREFETCH_WORKERS);
+
+     prefetch_lock = slock_new();
+     prefetch_cond = scond_new();
+     done_cond = scond_new();
+  }
+#endif
+
+  hunk_cache.resize(std::max<unsigned>(cache_hunks, 1));
+
+  for (unsigned i = 0; i < hunk_cache.size(); i++)
+  {
+     hunk_cache[i].hunknum = -1;
+     hunk_cache[i].last_used = 0;
+     hunk_cache[i].busy = false;
+     hunk_cache[i].data = (uint8_t *)malloc(head->hunkbytes);
+  }
 
   log_cb(RETRO_LOG_INFO, "chd_load '%s' hunkbytes=%d\n", path.c_str(), head->hunkbytes);
 
@@ -215,62 +391,236 @@ bool CDAccess_CHD::Load(const std::string &path, bool image_memcache)
 
 CDAccess_CHD::~CDAccess_CHD()
 {
+  Stop_Prefetch();
+
   if (chd != NULL)
     chd_close(chd);
 
-  if (hunkmem)
-    free(hunkmem);
+  for (unsigned i = 0; i < hunk_cache.size(); i++)
+    free(hunk_cache[i].data);
+
+  if (hunk_flat)
+    free(hunk_flat);
 }
 
-bool CDAccess_CHD::Read_CHD_Hunk_RAW(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track)
+bool CDAccess_CHD::Is_Fully_Cached(void)
+{
+  return hunk_flat != NULL;
+}
+
+bool CDAccess_CHD::Decompress_All(void)
 {
   const chd_header *head = chd_get_header(chd);
-  int cad = lba - track->LBA + track->fileOffset;
-  int sph = head->hunkbytes / (2352 + 96);
-  int hunknum = cad / sph; //(cad * head->unitbytes) / head->hunkbytes;
-  int hunkofs = cad % sph; //(cad * head->unitbytes) % head->hunkbytes;
-  int err = CHDERR_NONE;
+  const uint64_t flat_size = (uint64_t)head->totalhunks * head->hunkbytes;
+  DecompressJob job;
+  unsigned last_pct = 0;
 
-  /* each hunk holds ~8 sectors, optimize when reading contiguous sectors */
-  if (hunknum != oldhunk)
+  if (flat_size > SIZE_MAX || !(hunk_flat = (uint8_t *)malloc(flat_size)))
   {
-    err = chd_read(chd, hunknum, hunkmem);
-    if (err != CHDERR_NONE)
-      log_cb(RETRO_LOG_ERROR, "chd_read_sector failed lba=%d error=%d\n", lba, err);
-    else
-      oldhunk = hunknum;
+    log_cb(RETRO_LOG_WARN, "Not enough memory to decompress CHD image: %s\n", chd_path.c_str());
+    return false;
   }
 
-  memcpy(buf, hunkmem + hunkofs * (2352 + 96), 2352);
+  job.path = chd_path.c_str();
+  job.total_hunks = head->totalhunks;
+  job.hunk_bytes = head->hunkbytes;
+  job.dest = hunk_flat;
+  job.next_hunk = 0;
+  job.hunks_done = 0;
+  job.failed = false;
 
-  return err;
+#ifdef HAVE_THREADS
+  {
+    const unsigned num_threads = std::min<unsigned>(GetCoreCount(), MAX_DECOMPRESS_THREADS);
+    sthread_t *threads[MAX_DECOMPRESS_THREADS];
+
+    job.lock = slock_new();
+    job.cond = scond_new();
+    job.running = num_threads;
+
+    for (unsigned i = 0; i < num_threads; i++)
+    {
+      if (!(threads[i] = sthread_create(DecompressWorker, &job)))
+      {
+        slock_lock(job.lock);
+        job.running--;
+        slock_unlock(job.lock);
+      }
+    }
+
+    slock_lock(job.lock);
+    while (job.running)
+    {
+      const unsigned pct = (uint64_t)job.hunks_done * 100 / job.total_hunks;
+
+      if ((pct / 10) != (last_pct / 10))
+      {
+        MDFN_DispMessage("Decompressing CHD image: %u%%", pct);
+        last_pct = pct;
+      }
+
+      scond_wait(job.cond, job.lock);
+    }
+    slock_unlock(job.lock);
+
+    for (unsigned i = 0; i < num_threads; i++)
+    {
+      if (threads[i])
+        sthread_join(threads[i]);
+    }
+
+    scond_free(job.cond);
+    slock_free(job.lock);
+
+    log_cb(RETRO_LOG_INFO, "Decompressed %u CHD hunks with %u threads.\n", job.hunks_done, num_threads);
+  }
+#else
+  for (uint32_t i = 0; i < job.total_hunks && !job.failed; i++)
+  {
+    const unsigned pct = (uint64_t)i * 100 / job.total_hunks;
+
+    if ((pct / 10) != (last_pct / 10))
+    {
+      MDFN_DispMessage("Decompressing CHD image: %u%%", pct);
+      last_pct = pct;
+    }
+
+    job.failed = (chd_read(chd, i, hunk_flat + (uint64_t)i * job.hunk_bytes) != CHDERR_NONE);
+    job.hunks_done++;
+  }
+#endif
+
+  if (job.failed || job.hunks_done != job.total_hunks)
+  {
+    log_cb(RETRO_LOG_ERROR, "Failed to decompress CHD image: %s\n", chd_path.c_str());
+    free(hunk_flat);
+    hunk_flat = NULL;
+    return false;
+  }
+
+  return true;
 }
 
-bool CDAccess_CHD::Read_CHD_Hunk_M1(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track)
+void CDAccess_CHD::Start_Prefetch(void)
 {
-  const chd_header *head = chd_get_header(chd);
-  int cad = lba - track->LBA + track->fileOffset;
-  int sph = head->hunkbytes / (2352 + 96);
-  int hunknum = cad / sph; //(cad * head->unitbytes) / head->hunkbytes;
-  int hunkofs = cad % sph; //(cad * head->unitbytes) % head->hunkbytes;
-  int err = CHDERR_NONE;
+#ifdef HAVE_THREADS
+  prefetch_started = true;
+  prefetch_workers = new PrefetchWorker[NUM_PREFETCH_WORKERS];
 
-  /* each hunk holds ~8 sectors, optimize when reading contiguous sectors */
-  if (hunknum != oldhunk)
+  for (unsigned i = 0; i < NUM_PREFETCH_WORKERS; i++)
   {
-    err = chd_read(chd, hunknum, hunkmem);
-    if (err != CHDERR_NONE)
-      log_cb(RETRO_LOG_ERROR, "chd_read_sector failed lba=%d error=%d\n", lba, err);
-    else
-      oldhunk = hunknum;
+    PrefetchWorker *w = &prefetch_workers[num_prefetch_workers];
+
+    w->owner = this;
+    if (chd_open(chd_path.c_str(), CHD_OPEN_READ, NULL, &w->chd) != CHDERR_NONE)
+    {
+      log_cb(RETRO_LOG_WARN, "Failed to open CHD image for prefetching: %s\n", chd_path.c_str());
+      break;
+    }
+    w->thread = sthread_create(PrefetchWorker::Run, w);
+    num_prefetch_workers++;
   }
 
-  memcpy(buf + 16, hunkmem + hunkofs * (2352 + 96), 2048);
+  if (!num_prefetch_workers)
+    prefetch_hunks = 0;
+#endif
+}
 
-  return err;
+// Waits out any hunks being decompressed, and closes the workers' handles to the image.  Only done on closing the image, which
+// happens when the CDIF reading from it is deleted(on unloading the game).
+void CDAccess_CHD::Stop_Prefetch(void)
+{
+#ifdef HAVE_THREADS
+  if (num_prefetch_workers)
+  {
+    slock_lock(prefetch_lock);
+    prefetch_die = true;
+    scond_broadcast(prefetch_cond);
+    slock_unlock(prefetch_lock);
+
+    for (unsigned i = 0; i < num_prefetch_workers; i++)
+    {
+      sthread_join(prefetch_workers[i].thread);
+      chd_close(prefetch_workers[i].chd);
+    }
+    num_prefetch_workers = 0;
+  }
+
+  if (prefetch_workers)
+  {
+    delete[] prefetch_workers;
+    prefetch_workers = NULL;
+  }
+
+  if (prefetch_lock)
+  {
+    scond_free(done_cond);
+    scond_free(prefetch_cond);
+    slock_free(prefetch_lock);
+    done_cond = NULL;
+    prefetch_cond = NULL;
+    prefetch_lock = NULL;
+  }
+#endif
 }
 
-bool CDAccess_CHD::Read_CHD_Hunk_M2(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track)
+// Called with prefetch_lock held(if there is one).
+int CDAccess_CHD::Find_Hunk_Slot(uint32_t hunknum)
+{
+  for (unsigned i = 0; i < hunk_cache.size(); i++)
+  {
+    if (hunk_cache[i].hunknum == (int64_t)hunknum)
+      return i;
+  }
+
+  return -1;
+}
+
+// Called with prefetch_lock held(if there is one).  Returns the least recently used slot not being decompressed into, or -1 if there's none.
+int CDAccess_CHD::Claim_Hunk_Slot(void)
+{
+  int ret = -1;
+
+  for (unsigned i = 0; i < hunk_cache.size(); i++)
+  {
+    if (!hunk_cache[i].busy && (ret < 0 || hunk_cache[i].last_used < hunk_cache[ret].last_used))
+      ret = i;
+  }
+
+  return ret;
+}
+
+// Called with prefetch_lock held(if there is one).  Queues up the hunks following hunknum in the direction reading is going in.
+void CDAccess_CHD::Queue_Prefetch(uint32_t hunknum)
+{
+#ifdef HAVE_THREADS
+  if (prefetch_hunks && (int64_t)hunknum != last_hunk)
+  {
+    const chd_header *head = chd_get_header(chd);
+    const int dir = (last_hunk >= 0 && (int64_t)hunknum < last_hunk) ? -1 : 1;
+
+    prefetch_queue.clear();
+
+    for (unsigned i = 1; i <= prefetch_hunks; i++)
+    {
+      const int64_t h = (int64_t)hunknum + dir * (int64_t)i;
+
+      if (h < 0 || h >= head->totalhunks)
+        break;
+
+      if (Find_Hunk_Slot(h) < 0)
+        prefetch_queue.push_back(h);
+    }
+
+    if (!prefetch_queue.empty())
+      scond_broadcast(prefetch_cond);
+  }
+#endif
+
+  last_hunk = hunknum;
+}
+
+bool CDAccess_CHD::Read_CHD_Hunk_Sector(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track, uint32_t len)
 {
   const chd_header *head = chd_get_header(chd);
   int cad = lba - track->LBA + track->fileOffset;
@@ -278,22 +628,89 @@ bool CDAccess_CHD::Read_CHD_Hunk_M2(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INF
   int hunknum = cad / sph; //(cad * head->unitbytes) / head->hunkbytes;
   int hunkofs = cad % sph; //(cad * head->unitbytes) % head->hunkbytes;
   int err = CHDERR_NONE;
+  int slot;
 
-  /* each hunk holds ~8 sectors, optimize when reading contiguous sectors */
-  if (hunknum != oldhunk)
+  if (hunk_flat && (uint32_t)hunknum < head->totalhunks)
   {
-    err = chd_read(chd, hunknum, hunkmem);
-    if (err != CHDERR_NONE)
-      log_cb(RETRO_LOG_ERROR, "chd_read_sector failed lba=%d error=%d\n", lba, err);
-    else
-      oldhunk = hunknum;
+    memcpy(buf, hunk_flat + (uint64_t)hunknum * head->hunkbytes + hunkofs * (2352 + 96), len);
+    return err;
   }
 
-  memcpy(buf + 16, hunkmem + hunkofs * (2352 + 96), 2336);
+#ifdef HAVE_THREADS
+  if (prefetch_hunks && !prefetch_started)
+    Start_Prefetch();
+
+  if (prefetch_lock)
+    slock_lock(prefetch_lock);
+
+  /* wait out a prefetch of this hunk that's underway */
+  while ((slot = Find_Hunk_Slot(hunknum)) >= 0 && hunk_cache[slot].busy)
+    scond_wait(done_cond, prefetch_lock);
+
+  if (slot < 0)
+  {
+    while ((slot = Claim_Hunk_Slot()) < 0)
+      scond_wait(done_cond, prefetch_lock);
+
+    hunk_cache[slot].hunknum = hunknum;
+    hunk_cache[slot].busy = true;
+
+    if (prefetch_lock)
+      slock_unlock(prefetch_lock);
+
+    err = chd_read(chd, hunknum, hunk_cache[slot].data);
+
+    if (prefetch_lock)
+      slock_lock(prefetch_lock);
+
+    hunk_cache[slot].busy = false;
+
+    if (prefetch_lock)
+      scond_broadcast(done_cond);
+  }
+#else
+  if ((slot = Find_Hunk_Slot(hunknum)) < 0)
+  {
+    slot = Claim_Hunk_Slot();
+    hunk_cache[slot].hunknum = hunknum;
+    err = chd_read(chd, hunknum, hunk_cache[slot].data);
+  }
+#endif
+
+  if (err != CHDERR_NONE)
+  {
+    log_cb(RETRO_LOG_ERROR, "chd_read_sector failed lba=%d error=%d\n", lba, err);
+    hunk_cache[slot].hunknum = -1;
+  }
+
+  hunk_cache[slot].last_used = ++hunk_use_counter;
+  memcpy(buf, hunk_cache[slot].data + hunkofs * (2352 + 96), len);
+
+  Queue_Prefetch(hunknum);
+
+#ifdef HAVE_THREADS
+  if (prefetch_lock)
+    slock_unlock(prefetch_lock);
+#endif
 
   return err;
 }
 
+bool CDAccess_CHD::Read_CHD_Hunk_RAW(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track)
+{
+  return Read_CHD_Hunk_Sector(buf, lba, track, 2352);
+}
+
+bool CDAccess_CHD::Read_CHD_Hunk_M1(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track)
+{
+  return Read_CHD_Hunk_Sector(buf + 16, lba, track, 2048);
+}
+
+bool CDAccess_CHD::Read_CHD_Hunk_M2(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track)
+{
+  return Read_CHD_Hunk_Sector(buf + 16, lba, track, 2336);
+}
+
 bool CDAccess_CHD::Read_Raw_Sector(uint8_t *buf, int32_t lba)
 {
   uint8_t SimuQ[0xC];
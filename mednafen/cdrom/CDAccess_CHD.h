@@ -24,6 +24,11 @@
 
 #include "CDAccess.h"
 #include <libchdr/chd.h>
+#include <rthreads/rthreads.h>
+
+#include <deque>
+#include <string>
+#include <vector>
 
 struct CHDFILE_TRACK_INFO
 {
@@ -50,11 +55,13 @@ struct CHDFILE_TRACK_INFO
    uint32_t fileOffset;
 };
 
+struct PrefetchWorker;
+
 class CDAccess_CHD : public CDAccess
 {
  public:
 
- CDAccess_CHD(const std::string& path, bool image_memcache);
+ CDAccess_CHD(const std::string& path, unsigned image_cache);
  virtual ~CDAccess_CHD();
 
  virtual bool Read_Raw_Sector(uint8 *buf, int32 lba);
@@ -63,14 +70,24 @@ class CDAccess_CHD : public CDAccess
 
  virtual bool Read_TOC(TOC *toc);
 
+ virtual bool Is_Fully_Cached(void);
+
  private:
 
- bool Load(const std::string& path, bool image_memcache);
+ bool Load(const std::string& path, unsigned image_cache);
  void Cleanup(void);
 
   // MakeSubPQ will OR the simulated P and Q subchannel data into SubPWBuf.
   int32_t MakeSubPQ(int32_t lba, uint8_t *SubPWBuf) const;
 
+  bool Decompress_All(void);
+  bool Read_CHD_Hunk_Sector(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track, uint32_t len);
+  int Find_Hunk_Slot(uint32_t hunknum);
+  int Claim_Hunk_Slot(void);
+  void Queue_Prefetch(uint32_t hunknum);
+  void Start_Prefetch(void);
+  void Stop_Prefetch(void);
+
   bool Read_CHD_Hunk_RAW(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track);
   bool Read_CHD_Hunk_M1(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track);
   bool Read_CHD_Hunk_M2(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track);
@@ -90,8 +107,34 @@ class CDAccess_CHD : public CDAccess
   int num_tracks;
 
   chd_file *chd;
-  /* hunk data cache */
-  uint8_t *hunkmem;
-  /* last hunknum read */
-  int oldhunk;
+  std::string chd_path;
+
+  /* every hunk decompressed up front, with CDACCESS_IMAGE_DECOMPRESS; NULL otherwise */
+  uint8_t *hunk_flat;
+
+  /* decompressed hunk cache, least recently used hunk is replaced */
+  struct HunkSlot
+  {
+     int64_t hunknum;	/* -1 if empty */
+     uint64_t last_used;
+     bool busy;		/* being decompressed into, outside of the lock */
+     uint8_t *data;
+  };
+
+  std::vector<HunkSlot> hunk_cache;
+  uint64_t hunk_use_counter;
+  int64_t last_hunk;
+
+  /* hunks ahead of the read position (in the direction of reading) decompressed by worker threads */
+  unsigned prefetch_hunks;
+  std::deque<uint32_t> prefetch_queue;
+  PrefetchWorker *prefetch_workers;
+  unsigned num_prefetch_workers;
+  bool prefetch_started;
+  bool prefetch_die;
+  slock_t *prefetch_lock;
+  scond_t *prefetch_cond;	/* signalled when there's prefetching to do */
+  scond_t *done_cond;		/* broadcast when a slot stops being busy */
+
+  friend struct PrefetchWorker;
 };
@@ -188,7 +188,7 @@ uint32_t CDAccess_Image::GetSectorCount(CDRFILE_TRACK_INFO *track)
    return(0);
 }
 
-bool CDAccess_Image::ParseTOCFileLineInfo(CDRFILE_TRACK_INFO *track, const int tracknum, const std::string &filename, const char *binoffset, const char *msfoffset, const char *length, bool image_memcache, std::map<std::string, Stream*> &toc_streamcache)
+bool CDAccess_Image::ParseTOCFileLineInfo(CDRFILE_TRACK_INFO *track, const int tracknum, const std::string &filename, const char *binoffset, const char *msfoffset, const char *length, unsigned image_cache, std::map<std::string, Stream*> &toc_streamcache)
 {
    long offset = 0; // In bytes!
    long tmp_long;
@@ -211,10 +211,7 @@ bool CDAccess_Image::ParseTOCFileLineInfo(CDRFILE_TRACK_INFO *track, const int t
 
       efn = MDFN_EvalFIP(base_dir, filename);
 
-      if(image_memcache)
-         track->fp = new MemoryStream(new FileStream(efn.c_str(), MODE_READ));
-      else
-         track->fp = new FileStream(efn.c_str(), MODE_READ);
+      track->fp = CDAccess_OpenImageFile(efn, image_cache);
 
       toc_streamcache[filename] = track->fp;
    }
@@ -367,7 +364,7 @@ static bool StringToMSF(const char* str, unsigned* m, unsigned* s, unsigned* f)
    return true;
 }
 
-bool CDAccess_Image::ImageOpen(const std::string& path, bool image_memcache)
+bool CDAccess_Image::ImageOpen(const std::string& path, unsigned image_cache)
 {
    MemoryStream fp(new FileStream(path.c_str(), MODE_READ));
    static const unsigned max_args = 4;
@@ -522,7 +519,7 @@ bool CDAccess_Image::ImageOpen(const std::string& path, bool image_memcache)
                msfoffset = args[1].c_str();
                length = args[2].c_str();
             }
-            if (!ParseTOCFileLineInfo(&TmpTrack, active_track, args[0], binoffset, msfoffset, length, image_memcache, toc_streamcache))
+            if (!ParseTOCFileLineInfo(&TmpTrack, active_track, args[0], binoffset, msfoffset, length, image_cache, toc_streamcache))
                return false;
          }
          else if(cmdbuf == "DATAFILE")
@@ -538,7 +535,7 @@ bool CDAccess_Image::ImageOpen(const std::string& path, bool image_memcache)
             else
                length = args[1].c_str();
 
-            if (!ParseTOCFileLineInfo(&TmpTrack, active_track, args[0], binoffset, NULL, length, image_memcache, toc_streamcache))
+            if (!ParseTOCFileLineInfo(&TmpTrack, active_track, args[0], binoffset, NULL, length, image_cache, toc_streamcache))
                return false;
          }
          else if(cmdbuf == "INDEX")
@@ -639,11 +636,11 @@ bool CDAccess_Image::ImageOpen(const std::string& path, bool image_memcache)
             else
                efn = args[0];
 
-            TmpTrack.fp = new FileStream(efn.c_str(), MODE_READ);
+            TmpTrack.fp = CDAccess_OpenImageFile(efn, image_cache);
             TmpTrack.FirstFileInstance = 1;
 
-            if(image_memcache)
-               TmpTrack.fp = new MemoryStream(TmpTrack.fp);
+            // .flac files are usually listed as WAVE, since that's what the CUE sheets they were converted from said.
+            const bool flac_file = (efn.length() >= 5 && !strcasecmp(efn.c_str() + efn.length() - 5, ".flac"));
 
             if(!strcasecmp(args[1].c_str(), "BINARY"))
             {
@@ -652,12 +649,13 @@ bool CDAccess_Image::ImageOpen(const std::string& path, bool image_memcache)
                //fstat(fileno(TmpTrack.fp), &stat_buf);
                //TmpTrack.sectors = stat_buf.st_size; // / 2048;
             }
-            else if(!strcasecmp(args[1].c_str(), "WAVE") || !strcasecmp(args[1].c_str(), "WAV"))
+            else if((!strcasecmp(args[1].c_str(), "WAVE") || !strcasecmp(args[1].c_str(), "WAV")) && !flac_file)
             {
                // Make it work with WAVE / WAV file type names in the cue sheet, previously .wav was working only with BINARY
             }
             else if(!strcasecmp(args[1].c_str(), "OGG") || !strcasecmp(args[1].c_str(), "VORBIS") || !strcasecmp(args[1].c_str(), "PCM")
-                  || !strcasecmp(args[1].c_str(), "MPC") || !strcasecmp(args[1].c_str(), "MP+"))
+                  || !strcasecmp(args[1].c_str(), "MPC") || !strcasecmp(args[1].c_str(), "MP+")
+                  || !strcasecmp(args[1].c_str(), "FLAC") || flac_file)
             {
                TmpTrack.AReader = CDAFR_Open(TmpTrack.fp);
                if(!TmpTrack.AReader)
@@ -974,11 +972,11 @@ void CDAccess_Image::Cleanup(void)
    }
 }
 
-CDAccess_Image::CDAccess_Image(const std::string& path, bool image_memcache) : NumTracks(0), FirstTrack(0), LastTrack(0), total_sectors(0)
+CDAccess_Image::CDAccess_Image(const std::string& path, unsigned image_cache) : NumTracks(0), FirstTrack(0), LastTrack(0), total_sectors(0)
 {
    memset(Tracks, 0, sizeof(Tracks));
 
-   ImageOpen(path, image_memcache);
+   ImageOpen(path, image_cache);
 }
 
 CDAccess_Image::~CDAccess_Image()
@@ -1146,6 +1144,30 @@ bool CDAccess_Image::Read_Raw_Sector(uint8_t *buf, int32_t lba)
    return true;
 }
 
+//
+// Gets compressed audio tracks decoding from where playback will start, and the start of the next track since playback
+// will likely continue into it.  Only touches the track table, which doesn't change after the image is opened.
+//
+void CDAccess_Image::Hint_Audio_Play(int32_t lba)
+{
+   for(int32_t track = FirstTrack; track <= LastTrack; track++)
+   {
+      const CDRFILE_TRACK_INFO *ct = &Tracks[track];
+
+      if(lba >= (ct->LBA + ct->sectors))
+         continue;
+
+      if(ct->AReader)
+         ct->AReader->Hint((ct->FileOffset / 4) + std::max<int32_t>(0, lba - ct->LBA) * 588);
+
+      // Tracks sharing a file with this one are decoded into from here anyway.
+      if(track < LastTrack && Tracks[track + 1].AReader && Tracks[track + 1].AReader != ct->AReader)
+         Tracks[track + 1].AReader->Hint(Tracks[track + 1].FileOffset / 4);
+
+      break;
+   }
+}
+
 bool CDAccess_Image::Fast_Read_Raw_PW_TSRE(uint8_t* pwbuf, int32_t lba)
 {
    int32_t track;
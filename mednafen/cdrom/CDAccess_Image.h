@@ -55,7 +55,7 @@ class CDAccess_Image : public CDAccess
 {
    public:
 
-      CDAccess_Image(const std::string& path, bool image_memcache);
+      CDAccess_Image(const std::string& path, unsigned image_cache);
       virtual ~CDAccess_Image();
 
       virtual bool Read_Raw_Sector(uint8_t *buf, int32_t lba);
@@ -64,6 +64,8 @@ class CDAccess_Image : public CDAccess
 
       virtual bool Read_TOC(TOC *toc);
 
+      virtual void Hint_Audio_Play(int32_t lba);
+
    private:
 
       int32_t NumTracks;
@@ -78,7 +80,7 @@ class CDAccess_Image : public CDAccess
 
       std::string base_dir;
 
-      bool ImageOpen(const std::string& path, bool image_memcache);
+      bool ImageOpen(const std::string& path, unsigned image_cache);
       bool LoadSBI(const std::string& sbi_path);
       void GenerateTOC(void);
       void Cleanup(void);
@@ -86,7 +88,7 @@ class CDAccess_Image : public CDAccess
       // MakeSubPQ will OR the simulated P and Q subchannel data into SubPWBuf.
       int32_t MakeSubPQ(int32_t lba, uint8_t *SubPWBuf) const;
 
-      bool ParseTOCFileLineInfo(CDRFILE_TRACK_INFO *track, const int tracknum, const std::string &filename, const char *binoffset, const char *msfoffset, const char *length, bool image_memcache, std::map<std::string, Stream*> &toc_streamcache);
+      bool ParseTOCFileLineInfo(CDRFILE_TRACK_INFO *track, const int tracknum, const std::string &filename, const char *binoffset, const char *msfoffset, const char *length, unsigned image_cache, std::map<std::string, Stream*> &toc_streamcache);
       uint32_t GetSectorCount(CDRFILE_TRACK_INFO *track);
 };
 
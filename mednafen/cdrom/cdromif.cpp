@@ -29,20 +29,16 @@
 #include <rthreads/rthreads.h>
 #endif
 #include <retro_miscellaneous.h>
+#include <libretro.h>
+
+extern struct retro_perf_callback perf_cb;
 
 enum
 {
    /* Status/Error messages */
    CDIF_MSG_DONE = 0,		   /* Read -> emu. args: No args. */
    CDIF_MSG_INFO,			      /* Read -> emu. args: str_message */
-   CDIF_MSG_FATAL_ERROR,		/* Read -> emu. args: *TODO ARGS* */
-
-   /* Command messages. */
-   CDIF_MSG_DIEDIEDIE,		   /* Emu -> read */
-
-   CDIF_MSG_READ_SECTOR		   /* Emu -> read
-                              args[0] = lba
-                              */
+   CDIF_MSG_FATAL_ERROR		/* Read -> emu. args: *TODO ARGS* */
 };
 
 class CDIF_Message
@@ -61,6 +57,88 @@ class CDIF_Message
 };
 
 #ifdef HAVE_THREADS
+//
+// Just enough atomics(on 32-bit values) for the sector ring.  Loads and exchanges are sequentially consistent, stores
+// are release stores.
+//
+#if defined(_MSC_VER)
+#include <windows.h>
+#define CDIF_LOAD(p)		InterlockedCompareExchange((volatile LONG *)(p), 0, 0)
+#define CDIF_STORE(p, v)	InterlockedExchange((volatile LONG *)(p), (LONG)(v))
+#define CDIF_XCHG(p, v)		InterlockedExchange((volatile LONG *)(p), (LONG)(v))
+#define CDIF_FENCE()		MemoryBarrier()
+#elif defined(__ATOMIC_SEQ_CST)
+#define CDIF_LOAD(p)		__atomic_load_n((p), __ATOMIC_SEQ_CST)
+#define CDIF_STORE(p, v)	__atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define CDIF_XCHG(p, v)		__atomic_exchange_n((p), (v), __ATOMIC_SEQ_CST)
+#define CDIF_FENCE()		__atomic_thread_fence(__ATOMIC_SEQ_CST)
+#else
+#define CDIF_LOAD(p)		__sync_fetch_and_add((p), 0)
+#define CDIF_STORE(p, v)	do { __sync_synchronize(); *(volatile __typeof__(*(p)) *)(p) = (v); } while(0)
+#define CDIF_XCHG(p, v)		(__sync_synchronize(), __sync_lock_test_and_set((p), (v)))
+#define CDIF_FENCE()		__sync_synchronize()
+#endif
+
+//
+// Futex-style sleeping: the waiting thread only goes through the mutex and condition variable when what it's waiting
+// for isn't there yet, and the waking thread only when the other one is actually asleep.
+//
+// To wait:	Prepare(); if(still not there) Commit(); else Cancel();
+// To wake:	(make it be there) Wake();
+//
+class CDIF_Waiter
+{
+   public:
+
+      CDIF_Waiter() : sleeping(0)
+      {
+         lock = slock_new();
+         cond = scond_new();
+      }
+
+      ~CDIF_Waiter()
+      {
+         scond_free(cond);
+         slock_free(lock);
+      }
+
+      void Prepare(void)
+      {
+         slock_lock(lock);
+         CDIF_XCHG(&sleeping, 1);
+      }
+
+      void Commit(void)
+      {
+         scond_wait(cond, lock);
+         CDIF_STORE(&sleeping, 0);
+         slock_unlock(lock);
+      }
+
+      void Cancel(void)
+      {
+         CDIF_STORE(&sleeping, 0);
+         slock_unlock(lock);
+      }
+
+      void Wake(void)
+      {
+         CDIF_FENCE();
+
+         if(CDIF_LOAD(&sleeping))
+         {
+            slock_lock(lock);
+            scond_signal(cond);
+            slock_unlock(lock);
+         }
+      }
+
+   private:
+      slock_t *lock;
+      scond_t *cond;
+      int32_t sleeping;
+};
+
 class CDIF_Queue
 {
    public:
@@ -80,8 +158,7 @@ class CDIF_Queue
 
 typedef struct
 {
-   bool valid;
-   bool error;
+   uint32_t seq;	// Odd while the read thread is writing to it.
    int32_t lba;
    uint8_t data[2352 + 96];
 } CDIF_Sector_Buffer;
@@ -96,36 +173,72 @@ class CDIF_MT : public CDIF
 
       virtual void HintReadSector(int32_t lba);
       virtual bool ReadRawSector(uint8_t *buf, int32_t lba);
+      virtual uint8_t *BorrowRawSector(int32_t lba);
+      virtual void ReleaseRawSector(void);
       virtual bool ReadRawSectorPWOnly(uint8_t* pwbuf, int32_t lba, bool hint_fullread);
+      virtual void HintAudioPlay(int32_t lba);
+      virtual void GetReadStats(CDIF_Read_Stats *stats);
 
       // FIXME: Semi-private:
       int ReadThreadStart(void);
 
    private:
 
+      void RequestSector(int32_t lba);
+      int FindSector(int32_t lba);
+      void HandleRequest(int32_t new_lba);
+      void StoreSector(void);
+
       CDAccess *disc_cdaccess;
 
       sthread_t *CDReadThread;
 
-      // Queue for messages to the read thread.
-      CDIF_Queue ReadThreadQueue;
-
       // Queue for messages to the emu thread.
       CDIF_Queue EmuThreadQueue;
 
-
+      //
+      // Sectors read(ahead) by the read thread, which is the only one that writes to them.  Each one goes into the slot
+      // after the last one written, skipping over the slot the emu thread has borrowed(if any).  SBIndex maps an
+      // LBA(modulo SBIndexSize) to the slot it was last written to.
+      //
       enum { SBSize = 256 };
+      enum { SBIndexSize = SBSize * 2 };
+
       CDIF_Sector_Buffer SectorBuffers[SBSize];
+      int32_t SBIndex[SBIndexSize];
+      uint32_t SBWritePos;		/* Read-thread-only. */
+      int32_t SBBorrowed;		/* Slot borrowed by the emu thread, -1 if none. */
+      CDIF_Waiter SectorWaiter;		/* Emu thread waiting for a sector, or for room in ReqRing. */
+
+      //
+      // Sectors asked for by the emu thread, in order; ReqWritePos is only written by the emu thread, ReqReadPos only by
+      // the read thread.
+      //
+      enum { ReqSize = 64 };
 
-      uint32_t SBWritePos;
+      int32_t ReqRing[ReqSize];
+      uint32_t ReqWritePos;
+      uint32_t ReqReadPos;
+      CDIF_Waiter ReqWaiter;		/* Read thread waiting for a request. */
+      int32_t ReadThreadDie;
 
-      slock_t *SBMutex;
-      scond_t *SBCond;
+      enum { RA_INITIAL_DEPTH = 2 };
+      enum { RA_RAMP_RUN = 8 };
 
+      int32_t ra_max_depth;
+
+      /* Emu-thread-only(sectors_read and readahead_depth come from the two below instead): */
+      CDIF_Read_Stats Stats;
+
+      /* Written by the read thread: */
+      uint32_t SectorsRead;
+      uint32_t CurDepth;
 
       /* Read-thread-only: */
       int32_t ra_lba;
       int32_t ra_count;
+      int32_t ra_depth;		/* How far ahead of the last requested sector to read. */
+      int32_t ra_seq_run;	/* Sequential requests since ra_depth was last raised. */
       int32_t last_read_lba;
 };
 #endif
@@ -141,6 +254,7 @@ class CDIF_ST : public CDIF
       virtual void HintReadSector(int32_t lba);
       virtual bool ReadRawSector(uint8_t *buf, int32_t lba);
       virtual bool ReadRawSectorPWOnly(uint8_t* pwbuf, int32_t lba, bool hint_fullread);
+      virtual void HintAudioPlay(int32_t lba);
 
    private:
       CDAccess *disc_cdaccess;
@@ -156,6 +270,24 @@ CDIF::~CDIF()
 
 }
 
+void CDIF::GetReadStats(CDIF_Read_Stats *stats)
+{
+   memset(stats, 0, sizeof(*stats));
+}
+
+uint8_t *CDIF::BorrowRawSector(int32_t lba)
+{
+   if(!ReadRawSector(BorrowBuf, lba))
+      return(NULL);
+
+   return(BorrowBuf);
+}
+
+void CDIF::ReleaseRawSector(void)
+{
+
+}
+
 
 CDIF_Message::CDIF_Message()
 {
@@ -256,11 +388,11 @@ static int ReadThreadStart_C(void *v_arg)
 
 int CDIF_MT::ReadThreadStart()
 {
-   bool Running = true;
-
    SBWritePos = 0;
    ra_lba = 0;
    ra_count = 0;
+   ra_depth = RA_INITIAL_DEPTH;
+   ra_seq_run = 0;
    last_read_lba = LBA_Read_Maximum + 1;
 
    disc_cdaccess->Read_TOC(&disc_toc);
@@ -268,92 +400,141 @@ int CDIF_MT::ReadThreadStart()
    SBWritePos = 0;
    ra_lba = 0;
    ra_count = 0;
+   ra_depth = RA_INITIAL_DEPTH;
+   ra_seq_run = 0;
    last_read_lba = LBA_Read_Maximum + 1;
    memset(SectorBuffers, 0, SBSize * sizeof(CDIF_Sector_Buffer));
 
+   for(int i = 0; i < SBIndexSize; i++)
+      SBIndex[i] = -1;
+
    EmuThreadQueue.Write(CDIF_Message(CDIF_MSG_DONE));
 
-   while(Running)
+   while(!CDIF_LOAD(&ReadThreadDie))
    {
-      CDIF_Message msg;
+      bool took_requests = false;
 
-      // Only do a blocking-wait for a message if we don't have any sectors to read-ahead.
-      if(ReadThreadQueue.Read(&msg, ra_count ? false : true))
+      while(ReqReadPos != (uint32_t)CDIF_LOAD(&ReqWritePos))
       {
-         switch(msg.message)
-         {
-            case CDIF_MSG_DIEDIEDIE:
-               Running = false;
-               break;
-
-            case CDIF_MSG_READ_SECTOR:
-               {
-                  static const int max_ra = 16;
-                  static const int initial_ra = 1;
-                  static const int speedmult_ra = 2;
-                  int32_t new_lba = msg.args[0];
-
-                  if(new_lba == (last_read_lba + 1))
-                  {
-                     int how_far_ahead = ra_lba - new_lba;
-
-                     if(how_far_ahead <= max_ra)
-                        ra_count = MIN(speedmult_ra, 1 + max_ra - how_far_ahead);
-                     else
-                        ra_count++;
-                  }
-                  else if(new_lba != last_read_lba)
-                  {
-                     ra_lba = new_lba;
-                     ra_count = initial_ra;
-                  }
-
-                  last_read_lba = new_lba;
-               }
-               break;
-         }
+         HandleRequest(ReqRing[ReqReadPos % ReqSize]);
+         CDIF_STORE(&ReqReadPos, ReqReadPos + 1);
+         took_requests = true;
       }
 
+      // In case the emu thread is waiting for room in ReqRing.
+      if(took_requests)
+         SectorWaiter.Wake();
+
       /* Don't read beyond what the disc (image) readers can handle sanely. */
       if(ra_count && ra_lba == LBA_Read_Maximum)
          ra_count = 0;
 
       if(ra_count)
       {
-         uint8_t tmpbuf[2352 + 96];
-         bool error_condition = false;
-
-         disc_cdaccess->Read_Raw_Sector(tmpbuf, ra_lba);
-
-         slock_lock(SBMutex);
-
-         SectorBuffers[SBWritePos].lba = ra_lba;
-         memcpy(SectorBuffers[SBWritePos].data, tmpbuf, 2352 + 96);
-         SectorBuffers[SBWritePos].valid = true;
-         SectorBuffers[SBWritePos].error = error_condition;
-         SBWritePos = (SBWritePos + 1) % SBSize;
-
-         scond_signal(SBCond);
-         slock_unlock(SBMutex);
+         StoreSector();
 
          ra_lba++;
          ra_count--;
       }
+      else
+      {
+         // Only sleep if there's nothing to read ahead.
+         ReqWaiter.Prepare();
+
+         if(ReqReadPos == (uint32_t)CDIF_LOAD(&ReqWritePos) && !CDIF_LOAD(&ReadThreadDie))
+            ReqWaiter.Commit();
+         else
+            ReqWaiter.Cancel();
+      }
    }
 
    return(1);
 }
 
-CDIF_MT::CDIF_MT(CDAccess *cda) : disc_cdaccess(cda), CDReadThread(NULL), SBMutex(NULL), SBCond(NULL)
+void CDIF_MT::HandleRequest(int32_t new_lba)
+{
+   //
+   // Sequential reading(including skipping ahead into what's already been read ahead) doubles the read-ahead depth
+   // every RA_RAMP_RUN requests, up to ra_max_depth; anything else is taken as a seek, and drops it back down to
+   // RA_INITIAL_DEPTH.
+   //
+   if(new_lba == (last_read_lba + 1) || (new_lba > last_read_lba && new_lba < ra_lba))
+   {
+      if(++ra_seq_run >= RA_RAMP_RUN && ra_depth < ra_max_depth)
+      {
+         ra_depth = MIN(ra_max_depth, ra_depth * 2);
+         ra_seq_run = 0;
+      }
+
+      if(ra_lba < new_lba)
+         ra_lba = new_lba;
+
+      ra_count = MAX(0, new_lba + ra_depth - ra_lba);
+   }
+   else if(new_lba != last_read_lba)
+   {
+      ra_depth = RA_INITIAL_DEPTH;
+      ra_seq_run = 0;
+      ra_lba = new_lba;
+      ra_count = ra_depth;
+   }
+
+   last_read_lba = new_lba;
+}
+
+// Reads sector ra_lba into the next slot.
+void CDIF_MT::StoreSector(void)
+{
+   uint32_t slot = SBWritePos;
+   uint32_t seq;
+   int32_t old_index;
+
+   //
+   // The slot is marked as being written before checking that it isn't borrowed, whereas FindSector() marks it as
+   // borrowed before checking that it isn't being written, so one side or the other always backs off.
+   //
+   for(;;)
+   {
+      seq = SectorBuffers[slot].seq;
+      CDIF_XCHG(&SectorBuffers[slot].seq, seq + 1);
+
+      if(CDIF_LOAD(&SBBorrowed) != (int32_t)slot)
+         break;
+
+      CDIF_STORE(&SectorBuffers[slot].seq, seq);
+      slot = (slot + 1) % SBSize;
+   }
+
+   old_index = SectorBuffers[slot].lba & (SBIndexSize - 1);
+   if(SBIndex[old_index] == (int32_t)slot)
+      CDIF_STORE(&SBIndex[old_index], -1);
+
+   disc_cdaccess->Read_Raw_Sector(SectorBuffers[slot].data, ra_lba);
+
+   CDIF_STORE(&SectorBuffers[slot].lba, ra_lba);
+   CDIF_STORE(&SectorBuffers[slot].seq, seq + 2);
+   CDIF_STORE(&SBIndex[ra_lba & (SBIndexSize - 1)], slot);
+   SBWritePos = (slot + 1) % SBSize;
+
+   CDIF_STORE(&SectorsRead, SectorsRead + 1);
+   CDIF_STORE(&CurDepth, ra_depth);
+
+   SectorWaiter.Wake();
+}
+
+CDIF_MT::CDIF_MT(CDAccess *cda) : disc_cdaccess(cda), CDReadThread(NULL), SBBorrowed(-1), ReqWritePos(0), ReqReadPos(0), ReadThreadDie(0),
+                                   SectorsRead(0), CurDepth(0)
 {
    CDIF_Message msg;
    RTS_Args s;
 
-   SBMutex            = slock_new();
-   SBCond             = scond_new();
-
    UnrecoverableError = false;
 
+   memset(&Stats, 0, sizeof(Stats));
+
+   // Sectors read ahead mustn't overwrite ones that haven't been asked for yet, so leave half of the ring for those.
+   ra_max_depth = MAX((int32_t)RA_INITIAL_DEPTH, MIN((int32_t)SBSize / 2, (int32_t)MDFN_GetSettingUI("pcfx.cd_readahead")));
+
    s.cdif_ptr = this;
 
    CDReadThread = sthread_create((void (*)(void*))ReadThreadStart_C, &s);
@@ -364,22 +545,19 @@ CDIF_MT::~CDIF_MT()
 {
    bool thread_deaded_failed = false;
 
-   ReadThreadQueue.Write(CDIF_Message(CDIF_MSG_DIEDIEDIE));
+   CDIF_STORE(&ReadThreadDie, 1);
+   ReqWaiter.Wake();
 
    if(!thread_deaded_failed)
       sthread_join(CDReadThread);
 
-   if(SBMutex)
-   {
-      slock_free(SBMutex);
-      SBMutex = NULL;
-   }
+   // Only once the read thread is gone; this also stops whatever background threads the CDAccess has running.
+   delete disc_cdaccess;
+   disc_cdaccess = NULL;
 
-   if(SBCond)
-   {
-      scond_free(SBCond);
-      SBCond = NULL;
-   }
+   log_cb(RETRO_LOG_INFO, "CD read-ahead: %llu hits, %llu misses(%llu us waiting), %llu sectors read.\n",
+         (unsigned long long)Stats.hits, (unsigned long long)Stats.misses, (unsigned long long)Stats.wait_usec,
+         (unsigned long long)SectorsRead);
 }
 #endif
 
@@ -397,46 +575,105 @@ bool CDIF::ValidateRawSector(uint8_t *buf)
 }
 
 #ifdef HAVE_THREADS
-bool CDIF_MT::ReadRawSector(uint8_t *buf, int32_t lba)
+// Called from the emu thread only, like everything else that asks for sectors.
+void CDIF_MT::RequestSector(int32_t lba)
 {
-   bool found = false;
-   bool error_condition = false;
-
-   if(UnrecoverableError)
+   // Normally there's room, unless the read thread has been stuck on a slow read for a while.
+   while((ReqWritePos - (uint32_t)CDIF_LOAD(&ReqReadPos)) >= ReqSize)
    {
-      memset(buf, 0, 2352 + 96);
-      return(false);
-   }
+      SectorWaiter.Prepare();
 
-   if(lba < LBA_Read_Minimum || lba > LBA_Read_Maximum)
-   {
-      memset(buf, 0, 2352 + 96);
-      return(false);
+      if((ReqWritePos - (uint32_t)CDIF_LOAD(&ReqReadPos)) >= ReqSize)
+         SectorWaiter.Commit();
+      else
+         SectorWaiter.Cancel();
    }
 
-   ReadThreadQueue.Write(CDIF_Message(CDIF_MSG_READ_SECTOR, lba));
+   ReqRing[ReqWritePos % ReqSize] = lba;
+   CDIF_STORE(&ReqWritePos, ReqWritePos + 1);
+
+   ReqWaiter.Wake();
+}
+
+// Returns the slot holding lba, now borrowed, or -1 if it hasn't been read(or is being overwritten).
+int CDIF_MT::FindSector(int32_t lba)
+{
+   const int32_t slot = CDIF_LOAD(&SBIndex[lba & (SBIndexSize - 1)]);
 
-   slock_lock(SBMutex);
+   if(slot < 0)
+      return(-1);
+
+   CDIF_XCHG(&SBBorrowed, slot);
+
+   if(!(CDIF_LOAD(&SectorBuffers[slot].seq) & 1) && CDIF_LOAD(&SectorBuffers[slot].lba) == lba)
+      return(slot);
+
+   CDIF_STORE(&SBBorrowed, -1);
+
+   return(-1);
+}
+
+uint8_t *CDIF_MT::BorrowRawSector(int32_t lba)
+{
+   retro_time_t wait_start = 0;
+   int slot;
+
+   ReleaseRawSector();
+
+   if(UnrecoverableError)
+      return(NULL);
 
-   do
+   if(lba < LBA_Read_Minimum || lba > LBA_Read_Maximum)
+      return(NULL);
+
+   RequestSector(lba);
+
+   while((slot = FindSector(lba)) < 0)
    {
-      for(int i = 0; i < SBSize; i++)
+      if(!wait_start)
       {
-         if(SectorBuffers[i].valid && SectorBuffers[i].lba == lba)
-         {
-            error_condition = SectorBuffers[i].error;
-            memcpy(buf, SectorBuffers[i].data, 2352 + 96);
-            found = true;
-         }
+         Stats.misses++;
+         wait_start = perf_cb.get_time_usec ? perf_cb.get_time_usec() : 1;
       }
 
-      if(!found)
-         scond_wait((scond_t*)SBCond, (slock_t*)SBMutex);
-   } while(!found);
+      SectorWaiter.Prepare();
 
-   slock_unlock(SBMutex);
+      if((slot = FindSector(lba)) >= 0)
+      {
+         SectorWaiter.Cancel();
+         break;
+      }
+
+      SectorWaiter.Commit();
+   }
 
-   return(!error_condition);
+   if(!wait_start)
+      Stats.hits++;
+   else if(perf_cb.get_time_usec)
+      Stats.wait_usec += perf_cb.get_time_usec() - wait_start;
+
+   return(SectorBuffers[slot].data);
+}
+
+void CDIF_MT::ReleaseRawSector(void)
+{
+   CDIF_STORE(&SBBorrowed, -1);
+}
+
+bool CDIF_MT::ReadRawSector(uint8_t *buf, int32_t lba)
+{
+   uint8_t *sector = BorrowRawSector(lba);
+
+   if(!sector)
+   {
+      memset(buf, 0, 2352 + 96);
+      return(false);
+   }
+
+   memcpy(buf, sector, 2352 + 96);
+   ReleaseRawSector();
+
+   return(true);
 }
 
 bool CDIF_MT::ReadRawSectorPWOnly(uint8_t* pwbuf, int32_t lba, bool hint_fullread)
@@ -456,7 +693,7 @@ bool CDIF_MT::ReadRawSectorPWOnly(uint8_t* pwbuf, int32_t lba, bool hint_fullrea
    if(disc_cdaccess->Fast_Read_Raw_PW_TSRE(pwbuf, lba))
    {
       if(hint_fullread)
-         ReadThreadQueue.Write(CDIF_Message(CDIF_MSG_READ_SECTOR, lba));
+         RequestSector(lba);
 
       return(true);
    }
@@ -477,7 +714,24 @@ void CDIF_MT::HintReadSector(int32_t lba)
    if(UnrecoverableError)
       return;
 
-   ReadThreadQueue.Write(CDIF_Message(CDIF_MSG_READ_SECTOR, lba));
+   RequestSector(lba);
+}
+
+void CDIF_MT::HintAudioPlay(int32_t lba)
+{
+   if(UnrecoverableError)
+      return;
+
+   // Hint_Audio_Play() is thread-safe, and going through the read thread's queue would only delay it behind pending reads.
+   disc_cdaccess->Hint_Audio_Play(lba);
+}
+
+// Called from the emu thread.
+void CDIF_MT::GetReadStats(CDIF_Read_Stats *stats)
+{
+   *stats = Stats;
+   stats->sectors_read = CDIF_LOAD(&SectorsRead);
+   stats->readahead_depth = CDIF_LOAD(&CurDepth);
 }
 #endif
 
@@ -532,13 +786,22 @@ CDIF_ST::CDIF_ST(CDAccess *cda) : disc_cdaccess(cda)
 
 CDIF_ST::~CDIF_ST()
 {
-
+   delete disc_cdaccess;
+   disc_cdaccess = NULL;
 }
 
 void CDIF_ST::HintReadSector(int32_t lba)
 {
 }
 
+void CDIF_ST::HintAudioPlay(int32_t lba)
+{
+   if(UnrecoverableError)
+      return;
+
+   disc_cdaccess->Hint_Audio_Play(lba);
+}
+
 bool CDIF_ST::ReadRawSector(uint8_t *buf, int32_t lba)
 {
    if(UnrecoverableError)
@@ -586,11 +849,15 @@ bool CDIF_ST::ReadRawSectorPWOnly(uint8_t* pwbuf, int32_t lba, bool hint_fullrea
    }
 }
 
-CDIF *CDIF_Open(const std::string& path, bool image_memcache)
+CDIF *CDIF_Open(const std::string& path, unsigned image_cache)
 {
-   CDAccess *cda = CDAccess_Open(path, image_memcache);
+   CDAccess *cda = CDAccess_Open(path, image_cache);
 #ifdef HAVE_THREADS
-   if(!image_memcache)
+   // Only an image that's already all in memory(e.g. a fully decompressed CHD image) is read from on the emulation thread, as a
+   // separate thread would only add overhead.  The image cache fills in the background, and reads that get ahead of it go to
+   // the file; mapped images have to be paged in; and a CHD image that couldn't be decompressed in full falls back to
+   // decompressing hunks as they're needed.
+   if(!cda->Is_Fully_Cached())
       return new CDIF_MT(cda);
 #endif
    return new CDIF_ST(cda);
@@ -19,10 +19,21 @@
 #define __MDFN_CDROM_CDROMIF_H
 
 #include "CDUtility.h"
+#include "CDAccess.h"
 #include <mednafen/Stream.h>
 
 #include <queue>
 
+// Read statistics, for tuning read-ahead.
+struct CDIF_Read_Stats
+{
+ uint64_t hits;			// Sectors that had already been read(ahead) when they were asked for.
+ uint64_t misses;		// Sectors that had to be waited for.
+ uint64_t wait_usec;		// Time spent waiting for them(only counted if the frontend provides a timer).
+ uint64_t sectors_read;		// Sectors read from the disc image, read-ahead included.
+ uint32_t readahead_depth;	// Current read-ahead depth, in sectors.
+};
+
 class CDIF
 {
  public:
@@ -40,7 +51,16 @@ class CDIF
 
  virtual void HintReadSector(int32_t lba) = 0;
  virtual bool ReadRawSector(uint8_t *buf, int32_t lba) = 0;		// Reads 2352+96 bytes of data into buf.
+
+ // Like ReadRawSector(), but returns a pointer to the sector's 2352+96 bytes instead of copying them, or NULL on error.  The
+ // data may be modified in place, and stays valid until the next BorrowRawSector(), ReadRawSector() or ReleaseRawSector() call.
+ virtual uint8_t *BorrowRawSector(int32_t lba);
+ virtual void ReleaseRawSector(void);
+
  virtual bool ReadRawSectorPWOnly(uint8_t* pwbuf, int32_t lba, bool hint_fullread) = 0;	// Reads 96 bytes(of raw subchannel PW data) into pwbuf.
+ virtual void HintAudioPlay(int32_t lba) = 0;	// CD-DA playback is about to start at lba.
+
+ virtual void GetReadStats(CDIF_Read_Stats *stats);
 
  // Call for mode 1 or mode 2 form 1 only.
  bool ValidateRawSector(uint8_t *buf);
@@ -53,8 +73,11 @@ class CDIF
  protected:
  bool UnrecoverableError;
  TOC disc_toc;
+
+ private:
+ uint8_t BorrowBuf[2352 + 96];	// For the default BorrowRawSector().
 };
 
-CDIF *CDIF_Open(const std::string& path, bool image_memcache);
+CDIF *CDIF_Open(const std::string& path, unsigned image_cache);
 
 #endif
@@ -1446,6 +1446,7 @@ static void DoPABase(const uint32_t lba, const uint32_t length, unsigned int sta
   if(read_sec < toc.tracks[100].lba)
   {
    Cur_CDIF->HintReadSector(read_sec);	//, read_sec_end, read_sec_start);
+   Cur_CDIF->HintAudioPlay(read_sec);
   }
  }
 
@@ -1727,6 +1728,8 @@ static void DoPATRBase(const uint32_t lba, const uint32_t length)
 
   cdda.CDDAStatus = CDDASTATUS_PLAYING;
   cdda.PlayMode = PLAYMODE_NORMAL;
+
+  Cur_CDIF->HintAudioPlay(read_sec);
  }
 
  SendStatusAndMessage(STATUS_GOOD, 0x00);
@@ -2321,235 +2324,289 @@ static const int16_t OversampleFilter[2][0x10] =
  {    -43,    138,   -323,    645,  -1176,   2074,  -3844,   9724,  29464,  -5661,   2783,  -1562,    877,   -463,    217,    -82,  }, /* sum=32768, sum_abs=59076 */
 };
 
-static INLINE void RunCDDA(uint32_t system_timestamp, int32_t run_time)
+//
+// Moves CD-DA playback on to the next sector, and reads it in.  Returns false if playback stopped instead.
+//
+static bool NextCDDASector(void)
 {
- if(cdda.CDDAStatus == CDDASTATUS_PLAYING || cdda.CDDAStatus == CDDASTATUS_SCANNING)
+ if(read_sec >= read_sec_end || (cdda.CDDAStatus == CDDASTATUS_SCANNING && read_sec == cdda.scan_sec_end))
  {
-  cdda.CDDADiv -= (int64_t)run_time << 20;
-
-  while(cdda.CDDADiv <= 0)
+  switch(cdda.PlayMode)
   {
-   const uint32_t synthtime_ex = (((uint64_t)system_timestamp << 20) + (int64_t)cdda.CDDADiv) / cdda.CDDATimeDiv;
-   const int synthtime = (synthtime_ex >> 16) & 0xFFFF;	// & 0xFFFF(or equivalent) to prevent overflowing HRBufs[]
-   const int synthtime_phase = (int)(synthtime_ex & 0xFFFF) - 0x80;
-   const int synthtime_phase_int = synthtime_phase >> (16 - CDDA_FILTER_NUMPHASES_SHIFT);
-   const int synthtime_phase_fract = synthtime_phase & ((1 << (16 - CDDA_FILTER_NUMPHASES_SHIFT)) - 1);
-   int32_t sample_va[2];
+   case PLAYMODE_SILENT:
+   case PLAYMODE_NORMAL:
+    cdda.CDDAStatus = CDDASTATUS_STOPPED;
+    break;
 
-   cdda.CDDADiv += cdda.CDDADivAcc;
+   case PLAYMODE_INTERRUPT:
+    cdda.CDDAStatus = CDDASTATUS_STOPPED;
+    CDIRQCallback(SCSICD_IRQ_DATA_TRANSFER_DONE);
+    break;
 
-   if(!(cdda.OversamplePos & 1))
-   {
-    if(cdda.CDDAReadPos == 588)
-    {
-     if(read_sec >= read_sec_end || (cdda.CDDAStatus == CDDASTATUS_SCANNING && read_sec == cdda.scan_sec_end))
-     {
-      switch(cdda.PlayMode)
-      {
-       case PLAYMODE_SILENT:
-       case PLAYMODE_NORMAL:
-        cdda.CDDAStatus = CDDASTATUS_STOPPED;
-        break;
-
-       case PLAYMODE_INTERRUPT:
-        cdda.CDDAStatus = CDDASTATUS_STOPPED;
-        CDIRQCallback(SCSICD_IRQ_DATA_TRANSFER_DONE);
-        break;
-
-       case PLAYMODE_LOOP:
-        read_sec = read_sec_start;
-        break;
-      }
+   case PLAYMODE_LOOP:
+    read_sec = read_sec_start;
+    break;
+  }
 
-      // If CDDA playback is stopped, break out of our while(CDDADiv ...) loop and don't play any more sound!
-      if(cdda.CDDAStatus == CDDASTATUS_STOPPED)
-       break;
-     }
+  // If CDDA playback is stopped, don't play any more sound!
+  if(cdda.CDDAStatus == CDDASTATUS_STOPPED)
+   return false;
+ }
 
-     // Don't play past the user area of the disc.
-     if(read_sec >= toc.tracks[100].lba)
-     {
-      cdda.CDDAStatus = CDDASTATUS_STOPPED;
-      break;
-     }
+ // Don't play past the user area of the disc.
+ if(read_sec >= toc.tracks[100].lba)
+ {
+  cdda.CDDAStatus = CDDASTATUS_STOPPED;
+  return false;
+ }
 
-     if(TrayOpen || !Cur_CDIF)
-     {
-      cdda.CDDAStatus = CDDASTATUS_STOPPED;
-      break;
-     }
+ if(TrayOpen || !Cur_CDIF)
+ {
+  cdda.CDDAStatus = CDDASTATUS_STOPPED;
+  return false;
+ }
 
 
-     cdda.CDDAReadPos = 0;
+ cdda.CDDAReadPos = 0;
 
-     {
-      uint8_t tmpbuf[2352 + 96];
+ {
+  uint8_t tmpbuf[2352 + 96];
 
-      Cur_CDIF->ReadRawSector(tmpbuf, read_sec);	//, read_sec_end, read_sec_start);
+  Cur_CDIF->ReadRawSector(tmpbuf, read_sec);	//, read_sec_end, read_sec_start);
 
-      for(int i = 0; i < 588 * 2; i++)
-       cdda.CDDASectorBuffer[i] = MDFN_de16lsb(&tmpbuf[i * 2]);
+  for(int i = 0; i < 588 * 2; i++)
+   cdda.CDDASectorBuffer[i] = MDFN_de16lsb(&tmpbuf[i * 2]);
 
-      memcpy(cd.SubPWBuf, tmpbuf + 2352, 96);
-     }
-     GenSubQFromSubPW();
+  memcpy(cd.SubPWBuf, tmpbuf + 2352, 96);
+ }
+ GenSubQFromSubPW();
 
-     if(!(cd.SubQBuf_Last[0] & 0x10))
-     {
-      // Not using de-emphasis, so clear the de-emphasis filter state.
-      memset(cdda.DeemphState, 0, sizeof(cdda.DeemphState));
-     }
+ if(!(cd.SubQBuf_Last[0] & 0x10))
+ {
+  // Not using de-emphasis, so clear the de-emphasis filter state.
+  memset(cdda.DeemphState, 0, sizeof(cdda.DeemphState));
+ }
 
-     if(cdda.CDDAStatus == CDDASTATUS_SCANNING)
-     {
-      int64_t tmp_read_sec = read_sec;
+ if(cdda.CDDAStatus == CDDASTATUS_SCANNING)
+ {
+  int64_t tmp_read_sec = read_sec;
 
-      if(cdda.ScanMode & 1)
-      {
-       tmp_read_sec -= 24;
-       if(tmp_read_sec < cdda.scan_sec_end)
-        tmp_read_sec = cdda.scan_sec_end;
-      }
-      else
-      {
-       tmp_read_sec += 24;
-       if(tmp_read_sec > cdda.scan_sec_end)
-        tmp_read_sec = cdda.scan_sec_end;
-      }
-      read_sec = tmp_read_sec;
-     }
-     else
-      read_sec++;
-    } // End    if(CDDAReadPos == 588)
+  if(cdda.ScanMode & 1)
+  {
+   tmp_read_sec -= 24;
+   if(tmp_read_sec < cdda.scan_sec_end)
+    tmp_read_sec = cdda.scan_sec_end;
+  }
+  else
+  {
+   tmp_read_sec += 24;
+   if(tmp_read_sec > cdda.scan_sec_end)
+    tmp_read_sec = cdda.scan_sec_end;
+  }
+  read_sec = tmp_read_sec;
+ }
+ else
+  read_sec++;
 
-    if(!(cdda.CDDAReadPos % 6))
-    {
-     int subindex = cdda.CDDAReadPos / 6 - 2;
+ return true;
+}
 
-     if(subindex >= 0)
-      CDStuffSubchannels(cd.SubPWBuf[subindex], subindex);
-     else // The system-specific emulation code should handle what value the sync bytes are.
-      CDStuffSubchannels(0x00, subindex);
-    }
+#if defined(__SSE2__)
+//
+// High 32 bits of the signed 64-bit products of each coefficient(which must be >= 0) and s, i.e. ((int64_t)c * s) >> 32.
+// SSE2 only has an unsigned 32x32->64 multiply; the unsigned high half is too large by c when s is negative.
+//
+static INLINE __m128i MulCoeffHi(const __m128i c, const __m128i s)
+{
+ const __m128i p02 = _mm_mul_epu32(c, s);
+ const __m128i p13 = _mm_mul_epu32(_mm_srli_epi64(c, 32), s);
+ const __m128i hi = _mm_unpacklo_epi32(_mm_shuffle_epi32(p02, (1 << 0) | (3 << 2)), _mm_shuffle_epi32(p13, (1 << 0) | (3 << 2)));
 
-    // If the last valid sub-Q data decoded indicate that the corresponding sector is a data sector, don't output the
-    // current sector as audio.
-    if(!(cd.SubQBuf_Last[0] & 0x40) && cdda.PlayMode != PLAYMODE_SILENT)
-    {
-     cdda.sr[0] = cdda.CDDASectorBuffer[cdda.CDDAReadPos * 2 + cdda.OutPortChSelectCache[0]];
-     cdda.sr[1] = cdda.CDDASectorBuffer[cdda.CDDAReadPos * 2 + cdda.OutPortChSelectCache[1]];
-    }
+ return _mm_sub_epi32(hi, _mm_and_si128(c, _mm_srai_epi32(s, 31)));
+}
+#endif
 
+static INLINE void RunCDDA(uint32_t system_timestamp, int32_t run_time)
+{
+ if(cdda.CDDAStatus == CDDASTATUS_PLAYING || cdda.CDDAStatus == CDDASTATUS_SCANNING)
+ {
+  cdda.CDDADiv -= (int64_t)run_time << 20;
+
+  while(cdda.CDDADiv <= 0)
+  {
+   if(!(cdda.OversamplePos & 1) && cdda.CDDAReadPos == 588)
+   {
+    if(!NextCDDASector())
     {
-     const unsigned obwp = cdda.OversamplePos >> 1;
-     cdda.OversampleBuffer[0][obwp] = cdda.OversampleBuffer[0][0x10 + obwp] = cdda.sr[0];
-     cdda.OversampleBuffer[1][obwp] = cdda.OversampleBuffer[1][0x10 + obwp] = cdda.sr[1];
+     cdda.CDDADiv += cdda.CDDADivAcc;
+     break;
     }
+   }
 
-    cdda.CDDAReadPos++;
-   } // End if(!(cdda.OversamplePos & 1))
+   //
+   // Nothing below changes from one sample to the next within a sector, so only the per-sample work is left in
+   // the loop, which runs up to the next sector boundary(or until caught up).
+   //
+   // If the last valid sub-Q data decoded indicate that the corresponding sector is a data sector, don't output the
+   // current sector as audio.
+   //
+   const bool output_sector = !(cd.SubQBuf_Last[0] & 0x40) && cdda.PlayMode != PLAYMODE_SILENT;
+   const bool deemph = (bool)(cd.SubQBuf_Last[0] & 0x10);
 
+   do
    {
-    const int16_t* f = OversampleFilter[cdda.OversamplePos & 1];
-#if defined(__SSE2__)
-    __m128i f0 = _mm_load_si128((__m128i *)&f[0]);
-    __m128i f1 = _mm_load_si128((__m128i *)&f[8]);
-#endif
-      
-    for(unsigned lr = 0; lr < 2; lr++)
+    const uint32_t synthtime_ex = (((uint64_t)system_timestamp << 20) + (int64_t)cdda.CDDADiv) / cdda.CDDATimeDiv;
+    const int synthtime = (synthtime_ex >> 16) & 0xFFFF;	// & 0xFFFF(or equivalent) to prevent overflowing HRBufs[]
+    const int synthtime_phase = (int)(synthtime_ex & 0xFFFF) - 0x80;
+    const int synthtime_phase_int = synthtime_phase >> (16 - CDDA_FILTER_NUMPHASES_SHIFT);
+    const int synthtime_phase_fract = synthtime_phase & ((1 << (16 - CDDA_FILTER_NUMPHASES_SHIFT)) - 1);
+    int32_t sample_va[2];
+
+    cdda.CDDADiv += cdda.CDDADivAcc;
+
+    if(!(cdda.OversamplePos & 1))
     {
-     const int16_t* b = &cdda.OversampleBuffer[lr][((cdda.OversamplePos >> 1) + 1) & 0xF];
-#if defined(__SSE2__)
-     union
+     if(!(cdda.CDDAReadPos % 6))
+     {
+      int subindex = cdda.CDDAReadPos / 6 - 2;
+
+      if(subindex >= 0)
+       CDStuffSubchannels(cd.SubPWBuf[subindex], subindex);
+      else // The system-specific emulation code should handle what value the sync bytes are.
+       CDStuffSubchannels(0x00, subindex);
+     }
+
+     if(output_sector)
      {
-      int32_t accum;
-      float accum_f;
-      //__m128i accum_m128;
-     };
+      cdda.sr[0] = cdda.CDDASectorBuffer[cdda.CDDAReadPos * 2 + cdda.OutPortChSelectCache[0]];
+      cdda.sr[1] = cdda.CDDASectorBuffer[cdda.CDDAReadPos * 2 + cdda.OutPortChSelectCache[1]];
+     }
 
      {
-      __m128i b0  = _mm_loadu_si128((__m128i *)&b[0]);
-      __m128i b1  = _mm_loadu_si128((__m128i *)&b[8]);
-      __m128i sum = _mm_add_epi32(_mm_madd_epi16(f0, b0), _mm_madd_epi16(f1, b1));
-      sum         = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, (3 << 0) | (2 << 2) | (1 << 4) | (0 << 6)));
-      sum         = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, (1 << 0) | (0 << 2) | (3 << 4) | (2 << 6)));
-#ifdef _MSC_VER
-      _mm_store_ss(&accum_f, _mm_castsi128_ps(sum));
-#else
-      _mm_store_ss(&accum_f, (__m128)sum);
-#endif
-      //_mm_store_si128(&accum_m128, sum);
+      const unsigned obwp = cdda.OversamplePos >> 1;
+      cdda.OversampleBuffer[0][obwp] = cdda.OversampleBuffer[0][0x10 + obwp] = cdda.sr[0];
+      cdda.OversampleBuffer[1][obwp] = cdda.OversampleBuffer[1][0x10 + obwp] = cdda.sr[1];
      }
-#else
-     int32_t accum = 0;
 
-     for(unsigned i = 0; i < 0x10; i++)
-      accum += f[i] * b[i];
-#endif
-     // sum_abs * cdda_min =
-     // 59076 * -32768 = -1935802368
-     // OPVC can have a maximum value of 65536.
-     // -1935802368 * 65536 = -126864743989248
-     //
-     // -126864743989248 / 65536 = -1935802368
-     sample_va[lr] = ((int64_t)accum * cdda.OutPortVolumeCache[lr]) >> 16;
-     // Output of this stage will be (approximate max ranges) -2147450880 through 2147385345.
-    }
-   }
+     cdda.CDDAReadPos++;
+    } // End if(!(cdda.OversamplePos & 1))
 
-   //
-   // This de-emphasis filter's frequency response isn't totally correct, but it's much better than nothing(and it's not like any known PCE CD/TG16 CD/PC-FX games
-   // utilize pre-emphasis anyway).
-   //
-   if(MDFN_UNLIKELY(cd.SubQBuf_Last[0] & 0x10))
-   {
-    for(unsigned lr = 0; lr < 2; lr++)
     {
-     float inv = sample_va[lr] * 0.35971507338824012f;
+     const int16_t* f = OversampleFilter[cdda.OversamplePos & 1];
+     const unsigned bp = ((cdda.OversamplePos >> 1) + 1) & 0xF;
+     int32_t accum[2];
+#if defined(__SSE2__)
+     {
+      const __m128i f0 = _mm_load_si128((__m128i *)&f[0]);
+      const __m128i f1 = _mm_load_si128((__m128i *)&f[8]);
+      const __m128i sum_l = _mm_add_epi32(_mm_madd_epi16(f0, _mm_loadu_si128((__m128i *)&cdda.OversampleBuffer[0][bp + 0])),
+					  _mm_madd_epi16(f1, _mm_loadu_si128((__m128i *)&cdda.OversampleBuffer[0][bp + 8])));
+      const __m128i sum_r = _mm_add_epi32(_mm_madd_epi16(f0, _mm_loadu_si128((__m128i *)&cdda.OversampleBuffer[1][bp + 0])),
+					  _mm_madd_epi16(f1, _mm_loadu_si128((__m128i *)&cdda.OversampleBuffer[1][bp + 8])));
+      // Horizontal sums of both channels at once; lane 0 ends up with the left sum, lane 1 the right.
+      __m128i sum = _mm_add_epi32(_mm_unpacklo_epi32(sum_l, sum_r), _mm_unpackhi_epi32(sum_l, sum_r));
+
+      sum = _mm_add_epi32(sum, _mm_srli_si128(sum, 8));
+
+      accum[0] = _mm_cvtsi128_si32(sum);
+      accum[1] = _mm_cvtsi128_si32(_mm_srli_si128(sum, 4));
+     }
+#else
+     for(unsigned lr = 0; lr < 2; lr++)
+     {
+      const int16_t* b = &cdda.OversampleBuffer[lr][bp];
 
-     cdda.DeemphState[lr][1] = (cdda.DeemphState[lr][0] - 0.4316395666f * inv) + (0.7955522347f * cdda.DeemphState[lr][1]);
-     cdda.DeemphState[lr][0] = inv;
+      accum[lr] = 0;
 
-     sample_va[lr] = std::max<float>(-2147483648.0, std::min<float>(2147483647.0, cdda.DeemphState[lr][1]));
+      for(unsigned i = 0; i < 0x10; i++)
+       accum[lr] += f[i] * b[i];
+     }
+#endif
+     for(unsigned lr = 0; lr < 2; lr++)
+     {
+      // sum_abs * cdda_min =
+      // 59076 * -32768 = -1935802368
+      // OPVC can have a maximum value of 65536.
+      // -1935802368 * 65536 = -126864743989248
+      //
+      // -126864743989248 / 65536 = -1935802368
+      sample_va[lr] = ((int64_t)accum[lr] * cdda.OutPortVolumeCache[lr]) >> 16;
+      // Output of this stage will be (approximate max ranges) -2147450880 through 2147385345.
+     }
     }
-   }
-
 
-   if(HRBufs[0] && HRBufs[1])
-   {
     //
-    // FINAL_OUT_SHIFT should be 32 so we can take advantage of 32x32->64 multipliers on 32-bit CPUs.
+    // This de-emphasis filter's frequency response isn't totally correct, but it's much better than nothing(and it's not like any known PCE CD/TG16 CD/PC-FX games
+    // utilize pre-emphasis anyway).
     //
-    #define FINAL_OUT_SHIFT 32
-    #define MULT_SHIFT_ADJ (32 - (26 + (8 - CDDA_FILTER_NUMPHASES_SHIFT)))
-
-    #if (((1 << (16 - CDDA_FILTER_NUMPHASES_SHIFT)) - 0) << MULT_SHIFT_ADJ) > 32767
-     #error "COEFF MULT OVERFLOW"
-    #endif
+    if(MDFN_UNLIKELY(deemph))
+    {
+     for(unsigned lr = 0; lr < 2; lr++)
+     {
+      float inv = sample_va[lr] * 0.35971507338824012f;
 
-    const int16_t mult_a = ((1 << (16 - CDDA_FILTER_NUMPHASES_SHIFT)) - synthtime_phase_fract) << MULT_SHIFT_ADJ;
-    const int16_t mult_b = synthtime_phase_fract << MULT_SHIFT_ADJ;
-    int32_t coeff[CDDA_FILTER_NUMCONVOLUTIONS];
+      cdda.DeemphState[lr][1] = (cdda.DeemphState[lr][0] - 0.4316395666f * inv) + (0.7955522347f * cdda.DeemphState[lr][1]);
+      cdda.DeemphState[lr][0] = inv;
 
-    for(unsigned c = 0; c < CDDA_FILTER_NUMCONVOLUTIONS; c++)
-    {
-     coeff[c] = (CDDA_Filter[1 + synthtime_phase_int + 0][c] * mult_a + 
-		 CDDA_Filter[1 + synthtime_phase_int + 1][c] * mult_b);
+      sample_va[lr] = std::max<float>(-2147483648.0, std::min<float>(2147483647.0, cdda.DeemphState[lr][1]));
+     }
     }
 
-    int32_t* tb0 = &HRBufs[0][synthtime];
-    int32_t* tb1 = &HRBufs[1][synthtime];
 
-    for(unsigned c = 0; c < CDDA_FILTER_NUMCONVOLUTIONS; c++)
+    if(HRBufs[0] && HRBufs[1])
     {
-     tb0[c] += ((int64_t)coeff[c] * sample_va[0]) >> FINAL_OUT_SHIFT;
-     tb1[c] += ((int64_t)coeff[c] * sample_va[1]) >> FINAL_OUT_SHIFT;
+     //
+     // FINAL_OUT_SHIFT should be 32 so we can take advantage of 32x32->64 multipliers on 32-bit CPUs.
+     //
+     #define FINAL_OUT_SHIFT 32
+     #define MULT_SHIFT_ADJ (32 - (26 + (8 - CDDA_FILTER_NUMPHASES_SHIFT)))
+
+     #if (((1 << (16 - CDDA_FILTER_NUMPHASES_SHIFT)) - 0) << MULT_SHIFT_ADJ) > 32767
+      #error "COEFF MULT OVERFLOW"
+     #endif
+
+     const int16_t mult_a = ((1 << (16 - CDDA_FILTER_NUMPHASES_SHIFT)) - synthtime_phase_fract) << MULT_SHIFT_ADJ;
+     const int16_t mult_b = synthtime_phase_fract << MULT_SHIFT_ADJ;
+     int32_t* tb0 = &HRBufs[0][synthtime];
+     int32_t* tb1 = &HRBufs[1][synthtime];
+#if defined(__SSE2__)
+     //
+     // Both channels' impulses, all 8(7 + the zero padding) taps at once.  Coefficients are interpolated between the two
+     // phases with one multiply-add of interleaved filter rows, and can't be negative(see scsicd_cdda_filter.inc).
+     //
+     const __m128i fa = _mm_loadu_si128((__m128i *)CDDA_Filter[1 + synthtime_phase_int + 0]);
+     const __m128i fb = _mm_loadu_si128((__m128i *)CDDA_Filter[1 + synthtime_phase_int + 1]);
+     const __m128i mult = _mm_set1_epi32((uint16_t)mult_a | ((uint32_t)(uint16_t)mult_b << 16));
+     const __m128i coeff_lo = _mm_madd_epi16(_mm_unpacklo_epi16(fa, fb), mult);
+     const __m128i coeff_hi = _mm_madd_epi16(_mm_unpackhi_epi16(fa, fb), mult);
+     const __m128i s0 = _mm_set1_epi32(sample_va[0]);
+     const __m128i s1 = _mm_set1_epi32(sample_va[1]);
+
+     _mm_storeu_si128((__m128i *)&tb0[0], _mm_add_epi32(_mm_loadu_si128((__m128i *)&tb0[0]), MulCoeffHi(coeff_lo, s0)));
+     _mm_storeu_si128((__m128i *)&tb0[4], _mm_add_epi32(_mm_loadu_si128((__m128i *)&tb0[4]), MulCoeffHi(coeff_hi, s0)));
+     _mm_storeu_si128((__m128i *)&tb1[0], _mm_add_epi32(_mm_loadu_si128((__m128i *)&tb1[0]), MulCoeffHi(coeff_lo, s1)));
+     _mm_storeu_si128((__m128i *)&tb1[4], _mm_add_epi32(_mm_loadu_si128((__m128i *)&tb1[4]), MulCoeffHi(coeff_hi, s1)));
+#else
+     int32_t coeff[CDDA_FILTER_NUMCONVOLUTIONS];
+
+     for(unsigned c = 0; c < CDDA_FILTER_NUMCONVOLUTIONS; c++)
+     {
+      coeff[c] = (CDDA_Filter[1 + synthtime_phase_int + 0][c] * mult_a + 
+		  CDDA_Filter[1 + synthtime_phase_int + 1][c] * mult_b);
+     }
+
+     for(unsigned c = 0; c < CDDA_FILTER_NUMCONVOLUTIONS; c++)
+     {
+      tb0[c] += ((int64_t)coeff[c] * sample_va[0]) >> FINAL_OUT_SHIFT;
+      tb1[c] += ((int64_t)coeff[c] * sample_va[1]) >> FINAL_OUT_SHIFT;
+     }
+#endif
+     #undef FINAL_OUT_SHIFT
+     #undef MULT_SHIFT_ADJ
     }
-    #undef FINAL_OUT_SHIFT
-    #undef MULT_SHIFT_ADJ
-   }
 
-   cdda.OversamplePos = (cdda.OversamplePos + 1) & 0x1F;
+    cdda.OversamplePos = (cdda.OversamplePos + 1) & 0x1F;
+   } while(cdda.CDDADiv <= 0 && ((cdda.OversamplePos & 1) || cdda.CDDAReadPos != 588));
   } // end while(cdda.CDDADiv <= 0)
  }
 }
@@ -2569,7 +2626,7 @@ static INLINE void RunCDRead(uint32_t system_timestamp, int32_t run_time)
    }
    else
    {
-    uint8_t tmp_read_buf[2352 + 96];
+    uint8_t *sector = NULL;	// Borrowed from Cur_CDIF, rather than copied out.
 
     if(TrayOpen)
     {
@@ -2586,20 +2643,23 @@ static INLINE void RunCDRead(uint32_t system_timestamp, int32_t run_time)
     {
      CommandCCError(SENSEKEY_ILLEGAL_REQUEST, NSE_END_OF_VOLUME);
     }
-    else if(!Cur_CDIF->ReadRawSector(tmp_read_buf, SectorAddr))	//, SectorAddr + SectorCount))
+    else if(!(sector = Cur_CDIF->BorrowRawSector(SectorAddr)))	//, SectorAddr + SectorCount))
     {
      cd.data_transfer_done = FALSE;
 
      CommandCCError(SENSEKEY_ILLEGAL_REQUEST);
     }
-    else if(ValidateRawDataSector(tmp_read_buf, SectorAddr))
+    else if(ValidateRawDataSector(sector, SectorAddr))
     {
-     memcpy(cd.SubPWBuf, tmp_read_buf + 2352, 96);
+     memcpy(cd.SubPWBuf, sector + 2352, 96);
 
-     if(tmp_read_buf[12 + 3] == 0x2)
-      din->Write(tmp_read_buf + 24, 2048);
+     if(sector[12 + 3] == 0x2)
+      din->Write(sector + 24, 2048);
      else
-      din->Write(tmp_read_buf + 16, 2048);
+      din->Write(sector + 16, 2048);
+
+     Cur_CDIF->ReleaseRawSector();
+     sector = NULL;
 
      GenSubQFromSubPW();
 
@@ -2621,6 +2681,9 @@ static INLINE void RunCDRead(uint32_t system_timestamp, int32_t run_time)
       cd.data_transfer_done = TRUE;
      }
     }
+
+    if(sector)
+     Cur_CDIF->ReleaseRawSector();
    }				// end else to if(!Cur_CDIF->ReadSector
 
   }
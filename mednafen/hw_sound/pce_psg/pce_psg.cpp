@@ -17,11 +17,21 @@
 #include <assert.h>
 #include <math.h>
 #include <string.h>
+#include <algorithm>
 
 #include "mednafen/mednafen.h"
 #include "mednafen/state_helpers.h"
 #include "pce_psg.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(ARCH_X86) && defined(__GNUC__) && (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#include <immintrin.h>
+#define PCE_PSG_HAVE_AVX2
+#endif
+
 // Frequency cache cutoff optimization threshold (<= FREQC7M_COT)
 #define FREQC7M_COT	0x7 //0xA
 
@@ -62,6 +72,10 @@ static const int scale_tab[] =
    0x10, 0x13, 0x15, 0x17, 0x19, 0x1B, 0x1D, 0x1F
 };
 
+// Transitions per output sample, in 1/8ths, at or above which batched mode is used.
+#define BATCH_DENSITY		24
+#define BATCH_DENSITY_AVX2	16
+
 #define CLOCK_LFSR(lfsr) { unsigned int newbit = ((lfsr >> 0) ^ (lfsr >> 1) ^ (lfsr >> 11) ^ (lfsr >> 12) ^ (lfsr >> 17)) & 1; lfsr = (lfsr >> 1) | (newbit << 17); }
 
 static const int16 Phase_Filter[2][7] =
@@ -70,6 +84,150 @@ static const int16 Phase_Filter[2][7] =
  /*   1 */ {     6,   112,   425,   641,   579,   250,    35 }, //  2048
 };
 
+//
+// Phase_Filter padded out to 8 taps, with each coefficient in both 16-bit halves of its 32-bit lane(see MulPhaseFilter()).
+//
+static const MDFN_ALIGN(32) int32 Phase_Filter_Vec[2][8] =
+{
+ { 35 * 0x10001,  250 * 0x10001, 579 * 0x10001, 641 * 0x10001, 425 * 0x10001, 112 * 0x10001,  6 * 0x10001, 0 },
+ {  6 * 0x10001,  112 * 0x10001, 425 * 0x10001, 641 * 0x10001, 579 * 0x10001, 250 * 0x10001, 35 * 0x10001, 0 },
+};
+
+#if defined(__SSE2__)
+//
+// 32-bit delta * 16-bit coefficient, in each 32-bit lane, with the same wrapping result as the scalar code: the low
+// 32 bits of (delta_hi * 65536 + delta_lo) * c are ((delta_hi * c + ((delta_lo * c) >> 16)) << 16) + (delta_lo * c).
+//
+static INLINE __m128i MulPhaseFilter(const __m128i delta, const __m128i c)
+{
+ return _mm_add_epi32(_mm_mullo_epi16(delta, c), _mm_slli_epi32(_mm_mulhi_epu16(delta, c), 16));
+}
+#endif
+
+//
+// Adds the impulse response of a delta pair to the two output buffers, starting at l.
+//
+static INLINE void SynthDelta(int32* hr0, int32* hr1, const int32 l, const int32 phase, const int32 delta0, const int32 delta1)
+{
+#if defined(__SSE2__)
+ const __m128i c_lo = _mm_load_si128((const __m128i*)&Phase_Filter_Vec[phase][0]);
+ const __m128i c_hi = _mm_load_si128((const __m128i*)&Phase_Filter_Vec[phase][4]);
+ const __m128i d0 = _mm_set1_epi32(delta0);
+ const __m128i d1 = _mm_set1_epi32(delta1);
+
+ _mm_storeu_si128((__m128i*)&hr0[l + 0], _mm_add_epi32(_mm_loadu_si128((__m128i*)&hr0[l + 0]), MulPhaseFilter(d0, c_lo)));
+ _mm_storeu_si128((__m128i*)&hr0[l + 4], _mm_add_epi32(_mm_loadu_si128((__m128i*)&hr0[l + 4]), MulPhaseFilter(d0, c_hi)));
+ _mm_storeu_si128((__m128i*)&hr1[l + 0], _mm_add_epi32(_mm_loadu_si128((__m128i*)&hr1[l + 0]), MulPhaseFilter(d1, c_lo)));
+ _mm_storeu_si128((__m128i*)&hr1[l + 4], _mm_add_epi32(_mm_loadu_si128((__m128i*)&hr1[l + 4]), MulPhaseFilter(d1, c_hi)));
+#else
+ const int16* c = Phase_Filter[phase];
+
+ hr0[l + 0] += delta0 * c[0];
+ hr0[l + 1] += delta0 * c[1];
+ hr0[l + 2] += delta0 * c[2];
+ hr0[l + 3] += delta0 * c[3];
+ hr0[l + 4] += delta0 * c[4];
+ hr0[l + 5] += delta0 * c[5];
+ hr0[l + 6] += delta0 * c[6];
+
+ hr1[l + 0] += delta1 * c[0];
+ hr1[l + 1] += delta1 * c[1];
+ hr1[l + 2] += delta1 * c[2];
+ hr1[l + 3] += delta1 * c[3];
+ hr1[l + 4] += delta1 * c[4];
+ hr1[l + 5] += delta1 * c[5];
+ hr1[l + 6] += delta1 * c[6];
+#endif
+}
+
+//
+// Batched mode: deltas are summed per output buffer index and phase over a whole Update(), and then run through the
+// phase filters in one pass over the touched part of the buffers.  The integer arithmetic wraps the same way in any
+// order, so the result is identical to synthesizing each delta as it comes.
+//
+static void SynthDeltaBufs(int32* hr, int32* const* db, int32 start, const int32 end)
+{
+ for(; start < end; start++)
+ {
+  int32 acc = 0;
+
+  for(int k = 0; k < 7; k++)
+   acc += db[0][start - k] * Phase_Filter[0][k] + db[1][start - k] * Phase_Filter[1][k];
+
+  hr[start] += acc;
+ }
+}
+
+#if defined(__SSE2__)
+static void SynthDeltaBufs_SSE2(int32* hr, int32* const* db, const int32 start, const int32 end)
+{
+ for(int32 j = start; j < end; j += 4)
+ {
+  __m128i acc = _mm_setzero_si128();
+
+  for(int k = 0; k < 7; k++)
+  {
+   acc = _mm_add_epi32(acc, MulPhaseFilter(_mm_loadu_si128((__m128i*)&db[0][j - k]), _mm_set1_epi32(Phase_Filter_Vec[0][k])));
+   acc = _mm_add_epi32(acc, MulPhaseFilter(_mm_loadu_si128((__m128i*)&db[1][j - k]), _mm_set1_epi32(Phase_Filter_Vec[1][k])));
+  }
+
+  _mm_storeu_si128((__m128i*)&hr[j], _mm_add_epi32(_mm_loadu_si128((__m128i*)&hr[j]), acc));
+ }
+}
+#endif
+
+#ifdef PCE_PSG_HAVE_AVX2
+__attribute__((target("avx2"))) static void SynthDeltaBufs_AVX2(int32* hr, int32* const* db, const int32 start, const int32 end)
+{
+ for(int32 j = start; j < end; j += 8)
+ {
+  __m256i acc = _mm256_setzero_si256();
+
+  for(int k = 0; k < 7; k++)
+  {
+   acc = _mm256_add_epi32(acc, _mm256_mullo_epi32(_mm256_loadu_si256((__m256i*)&db[0][j - k]), _mm256_set1_epi32(Phase_Filter[0][k])));
+   acc = _mm256_add_epi32(acc, _mm256_mullo_epi32(_mm256_loadu_si256((__m256i*)&db[1][j - k]), _mm256_set1_epi32(Phase_Filter[1][k])));
+  }
+
+  _mm256_storeu_si256((__m256i*)&hr[j], _mm256_add_epi32(_mm256_loadu_si256((__m256i*)&hr[j]), acc));
+ }
+}
+#endif
+
+void PCE_PSG::FlushDeltas(void)
+{
+ const int32 start = DeltaMin;
+ const int32 end = DeltaMax + 7;
+
+ for(unsigned lr = 0; lr < 2; lr++)
+ {
+  int32* db[2] = { &DeltaBufs[lr][0][DELTA_BUF_PADDING], &DeltaBufs[lr][1][DELTA_BUF_PADDING] };
+
+#ifdef PCE_PSG_HAVE_AVX2
+  if(UseAVX2)
+   SynthDeltaBufs_AVX2(HRBufs[lr], db, start, end);
+  else
+#endif
+#if defined(__SSE2__)
+   SynthDeltaBufs_SSE2(HRBufs[lr], db, start, end);
+#else
+   SynthDeltaBufs(HRBufs[lr], db, start, end);
+#endif
+
+  for(unsigned phase = 0; phase < 2; phase++)
+   memset(&db[phase][start], 0, (DeltaMax + 1 - start) * sizeof(int32));
+ }
+
+ DeltaMin = INT32_MAX;
+ DeltaMax = -1;
+}
+
+void PCE_PSG::SetBatchDeltas(bool enabled)
+{
+ // Deltas are synthesized one at a time if the batch buffers couldn't be allocated.
+ BatchDeltas = enabled && DeltaBufs;
+}
+
 INLINE void PCE_PSG::UpdateOutputSub(const int32 timestamp, psg_channel *ch, const int32 samp0, const int32 samp1)
 {
  int32 delta[2];
@@ -77,24 +235,20 @@ INLINE void PCE_PSG::UpdateOutputSub(const int32 timestamp, psg_channel *ch, con
  delta[0] = samp0 - ch->blip_prev_samp[0];
  delta[1] = samp1 - ch->blip_prev_samp[1];
 
- const int16* c = Phase_Filter[(timestamp >> 1) & 1];
+ const int32 phase = (timestamp >> 1) & 1;
  const int32 l = (timestamp >> 2) & 0xFFFF;
 
- HRBufs[0][l + 0] += delta[0] * c[0];
- HRBufs[0][l + 1] += delta[0] * c[1];
- HRBufs[0][l + 2] += delta[0] * c[2];
- HRBufs[0][l + 3] += delta[0] * c[3];
- HRBufs[0][l + 4] += delta[0] * c[4];
- HRBufs[0][l + 5] += delta[0] * c[5];
- HRBufs[0][l + 6] += delta[0] * c[6];
-
- HRBufs[1][l + 0] += delta[1] * c[0];
- HRBufs[1][l + 1] += delta[1] * c[1];
- HRBufs[1][l + 2] += delta[1] * c[2];
- HRBufs[1][l + 3] += delta[1] * c[3];
- HRBufs[1][l + 4] += delta[1] * c[4];
- HRBufs[1][l + 5] += delta[1] * c[5];
- HRBufs[1][l + 6] += delta[1] * c[6];
+ if(BatchActive)
+ {
+  DeltaBufs[0][phase][DELTA_BUF_PADDING + l] += delta[0];
+  DeltaBufs[1][phase][DELTA_BUF_PADDING + l] += delta[1];
+  DeltaMin = std::min<int32>(DeltaMin, l);
+  DeltaMax = std::max<int32>(DeltaMax, l);
+ }
+ else
+  SynthDelta(HRBufs[0], HRBufs[1], l, phase, delta[0], delta[1]);
+
+ DeltaCount++;
 
  ch->blip_prev_samp[0] = samp0;
  ch->blip_prev_samp[1] = samp1;
@@ -371,6 +525,19 @@ PCE_PSG::PCE_PSG(int32* hr_l, int32* hr_r, int want_revision)
 	HRBufs[0] = hr_l;
 	HRBufs[1] = hr_r;
 
+	DeltaBufs = (int32 (*)[2][DELTA_BUF_PADDING + 65536 + DELTA_BUF_PADDING])calloc(2, sizeof(*DeltaBufs));
+	DeltaMin = INT32_MAX;
+	DeltaMax = -1;
+	DeltaCount = 0;
+	DeltaDense = false;
+	BatchDeltas = false;
+	BatchActive = false;
+	UseAVX2 = false;
+#ifdef PCE_PSG_HAVE_AVX2
+	__builtin_cpu_init();
+	UseAVX2 = __builtin_cpu_supports("avx2");
+#endif
+
 	lastts = 0;
 	for(int ch = 0; ch < 6; ch++)
 	{
@@ -385,7 +552,7 @@ PCE_PSG::PCE_PSG(int32* hr_l, int32* hr_r, int want_revision)
 
 PCE_PSG::~PCE_PSG()
 {
-
+ free(DeltaBufs);
 
 }
 
@@ -625,6 +792,9 @@ void PCE_PSG::Update(int32 timestamp)
 {
  int32 run_time = timestamp - lastts;
 
+ BatchActive = BatchDeltas && DeltaDense;
+ DeltaCount = 0;
+
  if(vol_pending && !vol_update_counter && !vol_update_which)
  {
   vol_update_counter = 1;
@@ -700,6 +870,16 @@ void PCE_PSG::Update(int32 timestamp)
 
   lastts = running_timestamp;
  }
+
+ if(BatchActive && DeltaMax >= 0)
+  FlushDeltas();
+
+ //
+ // The filter pass costs about the same for every output sample in the span, so it only comes out ahead of synthesizing
+ // each transition directly when there are enough of them per output sample(every 4 clocks).
+ //
+ if(run_time > 0)
+  DeltaDense = (uint64)DeltaCount * 4 * 8 >= (uint64)run_time * (UseAVX2 ? BATCH_DENSITY_AVX2 : BATCH_DENSITY);
 }
 
 void PCE_PSG::ResetTS(int32 ts_base)
@@ -116,6 +116,10 @@ class PCE_PSG
 
 	void SetVolume(double new_volume);
 
+	// When enabled, and the output transitions come thick enough, they're summed up during Update() and run through the
+	// phase filters in one pass at the end of it, rather than synthesized one at a time.  The result is the same either way.
+	void SetBatchDeltas(bool enabled);
+
 	void Update(int32 timestamp);
 	void ResetTS(int32 ts_base = 0);
 
@@ -145,6 +149,7 @@ class PCE_PSG
 	void RecalcFreqCache(int chnum);
 	void RecalcNoiseFreqCache(int chnum);
 	void RunChannel(int chc, int32 timestamp, bool LFO_On);
+	void FlushDeltas(void);
 
         uint8 select;               /* Selected channel (0-5) */
         uint8 globalbalance;        /* Global sound balance */
@@ -163,6 +168,16 @@ class PCE_PSG
 
 	int32* HRBufs[2];
 
+	// Batched mode state; DeltaBufs[lr][phase] is all zeroes outside of Update().
+	enum { DELTA_BUF_PADDING = 16 };
+	int32 (*DeltaBufs)[2][DELTA_BUF_PADDING + 65536 + DELTA_BUF_PADDING];
+	int32 DeltaMin, DeltaMax;
+	uint32 DeltaCount;
+	bool DeltaDense;
+	bool BatchDeltas;
+	bool BatchActive;
+	bool UseAVX2;
+
         int32 dbtable_volonly[32];
 
 	int32 dbtable[32][32];
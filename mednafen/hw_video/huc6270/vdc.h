@@ -268,6 +268,7 @@ class VDC
 	INLINE void PokeSAT(uint8 Address, const uint16 Data)
 	{
 	 SAT[Address] = Data;
+	 sprite_lines_dirty = true;
 	}
 
 
@@ -384,6 +385,7 @@ class VDC
 	void DrawBG(uint16 *target, int enabled);
 	void DrawSprites(uint16 *target, int enabled);
 	void FetchSpriteData(void);
+	void RebuildSpriteLines(void);
 
 
 	uint8 Simulate_select;
@@ -440,6 +442,11 @@ class VDC
 
         uint16 SAT[0x100];
 
+	// Per-RCRCount bitmask of the SAT entries whose vertical span covers that line, rebuilt
+	// lazily after the SAT changes.  Sprite Y(-64..959) + height(<=64) never reaches 1024.
+	uint64 sprite_line_mask[1024];
+	bool sprite_lines_dirty;
+
         uint16 VRAM[65536]; //VRAM_Size];
 
 	union
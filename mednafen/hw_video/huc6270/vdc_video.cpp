@@ -19,6 +19,10 @@
 
 #include <math.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include "mednafen/mednafen.h"
 #include "mednafen/lepacker.h"
 #include "mednafen/state_helpers.h"
@@ -578,6 +582,7 @@ int32 VDC::Run(int32 clocks, uint16 *pixels, bool skip)
          if(DVSSR > (VRAM_Size - 0x100))
           len = VRAM_Size - DVSSR;
          memcpy(SAT, &VRAM[DVSSR], len * sizeof(uint16));
+         sprite_lines_dirty = true;
         }
     }
    }
@@ -816,12 +821,23 @@ void VDC::DrawBG(uint16 *target, int enabled)
 
   if((MWR_cache & 0x3) == 0x3)
   {
+#if defined(__SSE2__)
+   const __m128i doh_v = _mm_set1_epi16(dohmask & 0xFF);
+#endif
+
    for(uint32 x = first_end; x < end; x+=8)
    {
     const uint16 bat = VRAM[bat_boom | bat_y];
     const uint8 pal_or = ((bat >> 8) & 0xF0);
     uint8 *pix_lut = bg_tile_cache[bat & 0xFFF][line_sub];
 
+#if defined(__SSE2__)
+    // Zero-extend the 8 cached pixels to 16 bits, then mask and OR in the palette bits for all of them at once.
+    __m128i pix = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)pix_lut), _mm_setzero_si128());
+
+    pix = _mm_or_si128(_mm_and_si128(pix, doh_v), _mm_set1_epi16(pal_or));
+    _mm_storeu_si128((__m128i *)(target + x), pix);
+#else
     (target + 0)[x] = (pix_lut[0] & dohmask) | pal_or;
     (target + 1)[x] = (pix_lut[1] & dohmask) | pal_or;
     (target + 2)[x] = (pix_lut[2] & dohmask) | pal_or;
@@ -830,6 +846,7 @@ void VDC::DrawBG(uint16 *target, int enabled)
     (target + 5)[x] = (pix_lut[5] & dohmask) | pal_or;
     (target + 6)[x] = (pix_lut[6] & dohmask) | pal_or;
     (target + 7)[x] = (pix_lut[7] & dohmask) | pal_or;
+#endif
 
     bat_boom = (bat_boom + 1) & bat_width_mask;
     BG_XOffset++;
@@ -844,7 +861,11 @@ void VDC::DrawBG(uint16 *target, int enabled)
    const uint8 pal_or = ((bat >> 8) & 0xF0);
    uint8 *pix_lut = bg_tile_cache[bat & 0xFFF][line_sub];
 
-#ifdef MSB_FIRST
+#if defined(__SSE2__)
+   __m128i pix = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)pix_lut), _mm_setzero_si128());
+
+   _mm_storeu_si128((__m128i *)(target + x), _mm_or_si128(pix, _mm_set1_epi16(pal_or)));
+#elif defined(MSB_FIRST)
    (target + 0)[x] = pix_lut[0] | pal_or;
    (target + 1)[x] = pix_lut[1] | pal_or;
    (target + 2)[x] = pix_lut[2] | pal_or;
@@ -907,13 +928,40 @@ static const unsigned int sprite_height_tab[4] = { 16, 32, 64, 64 };
 static const unsigned int sprite_height_no_mask[4] = { ~0U, ~2U, ~6U, ~6U };
 static const unsigned int sprite_width_tab[2] = { 16, 32 };
 
+void VDC::RebuildSpriteLines(void)
+{
+ memset(sprite_line_mask, 0, sizeof(sprite_line_mask));
+
+ for(int i = 0; i < 64; i++)
+ {
+  int32 y = (int32)(SAT[i * 4 + 0] & 0x3FF) - 0x40;
+  int32 y_end = y + sprite_height_tab[(SAT[i * 4 + 3] >> 12) & 3];
+
+  for(int32 line = (y < 0) ? 0 : y; line < y_end; line++)
+   sprite_line_mask[line] |= (uint64)1 << i;
+ }
+
+ sprite_lines_dirty = false;
+}
+
 void VDC::FetchSpriteData(void)
 {
+ uint64 line_mask;
+
  active_sprites = 0;
 
- // First, grab the up to 16 sprites.
- for(int i = 0; i < 64; i++)
+ if(sprite_lines_dirty)
+  RebuildSpriteLines();
+
+ line_mask = (RCRCount < 1024) ? sprite_line_mask[RCRCount] : 0;
+
+ // First, grab the up to 16 sprites, visiting only the SAT entries on this line(in SAT order).
+ while(line_mask)
  {
+  const int i = MDFN_tzcnt64(line_mask);
+
+  line_mask &= line_mask - 1;
+
   int16 y = (SAT[i * 4 + 0] & 0x3FF) - 0x40;
   uint16 x = (SAT[i * 4 + 1] & 0x3FF);
   uint16 no = (SAT[i * 4 + 2] >> 1) & 0x3FF;	// Todo, cg mode bit
@@ -1004,6 +1052,36 @@ void VDC::FetchSpriteData(void)
  sprite_cg_fetch_counter = ((active_sprites < 16) ? active_sprites : 16) * 4;
 }
 
+#if defined(__SSE2__)
+// Bit of the pattern data that supplies each of the 16 pixels, in normal and h-flipped order.
+static const MDFN_ALIGN(16) uint16 sprite_bit_tab[2][16] =
+{
+ { 0x8000, 0x4000, 0x2000, 0x1000, 0x0800, 0x0400, 0x0200, 0x0100, 0x0080, 0x0040, 0x0020, 0x0010, 0x0008, 0x0004, 0x0002, 0x0001 },
+ { 0x0001, 0x0002, 0x0004, 0x0008, 0x0010, 0x0020, 0x0040, 0x0080, 0x0100, 0x0200, 0x0400, 0x0800, 0x1000, 0x2000, 0x4000, 0x8000 },
+};
+
+// Converts the 4 bitplanes of a sprite line into 16 4-bit pixels, 8 per vector.
+static INLINE void SpritePlanarToChunky(const SPRLE *spr, __m128i *pixels)
+{
+ const uint16 *bit_tab = sprite_bit_tab[(spr->flags & SPRF_HFLIP) ? 1 : 0];
+
+ for(unsigned h = 0; h < 2; h++)
+ {
+  const __m128i bits = _mm_load_si128((const __m128i *)&bit_tab[h * 8]);
+  __m128i raw = _mm_setzero_si128();
+
+  for(unsigned plane = 0; plane < 4; plane++)
+  {
+   const __m128i pd = _mm_and_si128(_mm_set1_epi16(spr->pattern_data[plane]), bits);
+
+   raw = _mm_or_si128(raw, _mm_and_si128(_mm_cmpeq_epi16(pd, bits), _mm_set1_epi16(1 << plane)));
+  }
+
+  pixels[h] = raw;
+ }
+}
+#endif
+
 void VDC::DrawSprites(uint16 *target, int enabled)
 {
  MDFN_ALIGN(16) uint16 sprite_line_buf[1024];
@@ -1023,6 +1101,42 @@ void VDC::DrawSprites(uint16 *target, int enabled)
   if(SpriteList[i].flags & SPRF_PRIORITY) 
    prio_or = 0x200;
 
+#if defined(__SSE2__)
+  // Sprites entirely inside the display area are merged 8 pixels at a time; the ones straddling an edge
+  // go through the per-pixel clipping loops below.
+  if(pos >= (int32)start && (uint32)(pos + 16) <= end)
+  {
+   const bool hit_test = (SpriteList[i].flags & SPRF_SPRITE0) && (CR & 0x01);
+   const __m128i pix_or = _mm_set1_epi16(SpriteList[i].palette_index | 0x100 | prio_or);
+   const __m128i zero = _mm_setzero_si128();
+   __m128i raw[2];
+
+   SpritePlanarToChunky(&SpriteList[i], raw);
+
+   for(unsigned h = 0; h < 2; h++)
+   {
+    __m128i *dest = (__m128i *)&sprite_line_buf[pos + h * 8];
+    const __m128i transparent = _mm_cmpeq_epi16(raw[h], zero);
+    __m128i old = _mm_loadu_si128(dest);
+
+    if(hit_test)
+    {
+     const __m128i old_transparent = _mm_cmpeq_epi16(_mm_and_si128(old, _mm_set1_epi16(0xF)), zero);
+
+     if(_mm_movemask_epi8(_mm_or_si128(transparent, old_transparent)) != 0xFFFF)
+     {
+      status |= VDCS_CR;
+      IRQHook(TRUE);
+     }
+    }
+
+    old = _mm_or_si128(_mm_and_si128(transparent, old), _mm_andnot_si128(transparent, _mm_or_si128(raw[h], pix_or)));
+    _mm_storeu_si128(dest, old);
+   }
+   continue;
+  }
+#endif
+
   if((SpriteList[i].flags & SPRF_SPRITE0) && (CR & 0x01))
   {
    for(uint32 x = 0; x < 16; x++)
@@ -1087,7 +1201,29 @@ void VDC::DrawSprites(uint16 *target, int enabled)
 
  if(enabled)
  {
-  for(unsigned int x = start; x < end; x++)
+  unsigned int x = start;
+
+#if defined(__SSE2__)
+  {
+   const __m128i zero = _mm_setzero_si128();
+   const __m128i low_mask = _mm_set1_epi16(0x0F);
+   const __m128i prio_mask = _mm_set1_epi16(0x200);
+
+   for(; (x + 8) <= end; x += 8)
+   {
+    const __m128i spr = _mm_loadu_si128((const __m128i *)&sprite_line_buf[x]);
+    const __m128i bg = _mm_loadu_si128((const __m128i *)&target[x]);
+    const __m128i spr_transparent = _mm_cmpeq_epi16(_mm_and_si128(spr, low_mask), zero);
+    const __m128i bg_transparent = _mm_cmpeq_epi16(_mm_and_si128(bg, low_mask), zero);
+    const __m128i spr_prio = _mm_cmpeq_epi16(_mm_and_si128(spr, prio_mask), prio_mask);
+    const __m128i sel = _mm_andnot_si128(spr_transparent, _mm_or_si128(bg_transparent, spr_prio));
+
+    _mm_storeu_si128((__m128i *)&target[x], _mm_or_si128(_mm_andnot_si128(sel, bg), _mm_and_si128(sel, _mm_and_si128(spr, _mm_set1_epi16(0x1FF)))));
+   }
+  }
+#endif
+
+  for(; x < end; x++)
   {
    if(sprite_line_buf[x] & 0x0F)
    {
@@ -1432,6 +1568,7 @@ int32 VDC::Reset(void)
 {
  memset(VRAM, 0, sizeof(VRAM));
  memset(SAT, 0, sizeof(SAT));
+ sprite_lines_dirty = true;
  memset(SpriteList, 0, sizeof(SpriteList));
 
  for(uint32 A = 0; A < 65536; A += 16)
@@ -1542,6 +1679,8 @@ VDC::VDC(bool nospritelimit, uint32 par_VRAM_Size)
 
  in_exhsync = false;
  in_exvsync = false;
+
+ sprite_lines_dirty = true;
 }
 
 VDC::~VDC()
@@ -1673,6 +1812,7 @@ int VDC::StateAction(StateMem *sm, int load, int data_only, const char *sname)
   if(load)
   {
    StateExtra(sl_packer, true);
+   sprite_lines_dirty = true;
 
    for(int x = 0; x < VRAM_Size; x++)
     FixTileCache(x);
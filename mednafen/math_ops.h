@@ -36,4 +36,22 @@ static INLINE uint32 round_up_pow2(uint32 v)
 // convert those faster with typecasts...
 #define sign_x_to_s32(_bits, _value) (((int32)((uint32)(_value) << (32 - _bits))) >> (32 - _bits))
 
+// Index of the lowest set bit; v must be non-zero.
+static INLINE unsigned MDFN_tzcnt64(uint64 v)
+{
+#if defined(__GNUC__)
+   return __builtin_ctzll(v);
+#else
+   unsigned ret = 0;
+
+   while(!(v & 1))
+   {
+      v >>= 1;
+      ret++;
+   }
+
+   return(ret);
+#endif
+}
+
 #endif
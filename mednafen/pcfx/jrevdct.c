@@ -23,6 +23,15 @@
 #include "../mednafen-types.h"
 #include "jrevdct.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#include <immintrin.h>
+#define JREVDCT_HAVE_AVX2
+#endif
+
 /*
  * This routine is specialized to the case DCTSIZE = 8.
  */
@@ -129,7 +138,7 @@
  * Perform the inverse DCT on one block of coefficients.
  */
 
-void j_rev_dct(DCTBLOCK data)
+static void j_rev_dct_c(DCTBLOCK data)
 {
   int32 tmp0, tmp1, tmp2, tmp3;
   int32 tmp10, tmp11, tmp12, tmp13;
@@ -278,3 +287,209 @@ void j_rev_dct(DCTBLOCK data)
     dataptr++;			/* advance pointer to next column */
   }
 }
+
+/*
+ * SSE2: 4 rows/columns per vector.  SSE2 has no 32-bit low multiply, so
+ * build one out of two 32x32->64 multiplies unless SSE4.1 is available.
+ */
+#if defined(__SSE2__)
+static INLINE __m128i mullo_epi32_sse2(__m128i a, __m128i b)
+{
+#if defined(__SSE4_1__)
+  return _mm_mullo_epi32(a, b);
+#else
+  __m128i even = _mm_mul_epu32(a, b);
+  __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+
+  return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+#endif
+}
+
+#define VEC		__m128i
+#define V_ADD(a, b)	_mm_add_epi32(a, b)
+#define V_SUB(a, b)	_mm_sub_epi32(a, b)
+#define V_MUL(a, k)	mullo_epi32_sse2(a, _mm_set1_epi32(k))
+#define V_SHL(a, n)	_mm_slli_epi32(a, n)
+#define V_DESCALE(a, n)	_mm_srai_epi32(_mm_add_epi32(a, _mm_set1_epi32(ONE << ((n)-1))), n)
+#define V_LOAD(p)	_mm_loadu_si128((const __m128i *)(p))
+#define V_STORE(p, v)	_mm_storeu_si128((__m128i *)(p), v)
+#define V_TRANSPOSE4(a, b, c, d)			\
+  {							\
+    __m128i t0 = _mm_unpacklo_epi32(a, b);		\
+    __m128i t1 = _mm_unpacklo_epi32(c, d);		\
+    __m128i t2 = _mm_unpackhi_epi32(a, b);		\
+    __m128i t3 = _mm_unpackhi_epi32(c, d);		\
+    a = _mm_unpacklo_epi64(t0, t1);			\
+    b = _mm_unpackhi_epi64(t0, t1);			\
+    c = _mm_unpacklo_epi64(t2, t3);			\
+    d = _mm_unpackhi_epi64(t2, t3);			\
+  }
+
+#define JREVDCT_4LANE_NAME j_rev_dct_sse2
+#include "jrevdct_4lane.inc"
+#undef JREVDCT_4LANE_NAME
+
+#undef VEC
+#undef V_ADD
+#undef V_SUB
+#undef V_MUL
+#undef V_SHL
+#undef V_DESCALE
+#undef V_LOAD
+#undef V_STORE
+#undef V_TRANSPOSE4
+
+/*
+ * Generic GCC/clang vector extensions, for the other SIMD-capable targets(NEON, AltiVec).
+ */
+#elif defined(__GNUC__) && (defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(__ALTIVEC__))
+typedef int32 v4si __attribute__((vector_size(16)));
+
+#define VEC		v4si
+#define V_SPLAT(k)	((v4si){ (k), (k), (k), (k) })
+#define V_ADD(a, b)	((a) + (b))
+#define V_SUB(a, b)	((a) - (b))
+#define V_MUL(a, k)	((a) * V_SPLAT(k))
+#define V_SHL(a, n)	((a) << V_SPLAT(n))
+#define V_DESCALE(a, n)	(((a) + V_SPLAT(ONE << ((n)-1))) >> V_SPLAT(n))
+#define V_LOAD(p)	((v4si){ (p)[0], (p)[1], (p)[2], (p)[3] })
+#define V_STORE(p, v)	{ (p)[0] = (v)[0]; (p)[1] = (v)[1]; (p)[2] = (v)[2]; (p)[3] = (v)[3]; }
+#define V_TRANSPOSE4(a, b, c, d)			\
+  {							\
+    v4si t0 = { a[0], b[0], c[0], d[0] };		\
+    v4si t1 = { a[1], b[1], c[1], d[1] };		\
+    v4si t2 = { a[2], b[2], c[2], d[2] };		\
+    v4si t3 = { a[3], b[3], c[3], d[3] };		\
+    a = t0; b = t1; c = t2; d = t3;			\
+  }
+
+#define JREVDCT_4LANE_NAME j_rev_dct_vec
+#include "jrevdct_4lane.inc"
+#undef JREVDCT_4LANE_NAME
+
+#undef VEC
+#undef V_SPLAT
+#undef V_ADD
+#undef V_SUB
+#undef V_MUL
+#undef V_SHL
+#undef V_DESCALE
+#undef V_LOAD
+#undef V_STORE
+#undef V_TRANSPOSE4
+#endif
+
+/*
+ * AVX2: a whole 8x8 pass per set of vectors, with a full 8x8 transpose
+ * before each pass.  Only used when the CPU reports AVX2 support.
+ */
+#ifdef JREVDCT_HAVE_AVX2
+#define VEC		__m256i
+#define V_ADD(a, b)	_mm256_add_epi32(a, b)
+#define V_SUB(a, b)	_mm256_sub_epi32(a, b)
+#define V_MUL(a, k)	_mm256_mullo_epi32(a, _mm256_set1_epi32(k))
+#define V_SHL(a, n)	_mm256_slli_epi32(a, n)
+#define V_DESCALE(a, n)	_mm256_srai_epi32(_mm256_add_epi32(a, _mm256_set1_epi32(ONE << ((n)-1))), n)
+
+#define V_TRANSPOSE8(r0, r1, r2, r3, r4, r5, r6, r7)				\
+  {										\
+    __m256i t0 = _mm256_unpacklo_epi32(r0, r1), t1 = _mm256_unpackhi_epi32(r0, r1);	\
+    __m256i t2 = _mm256_unpacklo_epi32(r2, r3), t3 = _mm256_unpackhi_epi32(r2, r3);	\
+    __m256i t4 = _mm256_unpacklo_epi32(r4, r5), t5 = _mm256_unpackhi_epi32(r4, r5);	\
+    __m256i t6 = _mm256_unpacklo_epi32(r6, r7), t7 = _mm256_unpackhi_epi32(r6, r7);	\
+    __m256i u0 = _mm256_unpacklo_epi64(t0, t2), u1 = _mm256_unpackhi_epi64(t0, t2);	\
+    __m256i u2 = _mm256_unpacklo_epi64(t1, t3), u3 = _mm256_unpackhi_epi64(t1, t3);	\
+    __m256i u4 = _mm256_unpacklo_epi64(t4, t6), u5 = _mm256_unpackhi_epi64(t4, t6);	\
+    __m256i u6 = _mm256_unpacklo_epi64(t5, t7), u7 = _mm256_unpackhi_epi64(t5, t7);	\
+    r0 = _mm256_permute2x128_si256(u0, u4, 0x20);					\
+    r1 = _mm256_permute2x128_si256(u1, u5, 0x20);					\
+    r2 = _mm256_permute2x128_si256(u2, u6, 0x20);					\
+    r3 = _mm256_permute2x128_si256(u3, u7, 0x20);					\
+    r4 = _mm256_permute2x128_si256(u0, u4, 0x31);					\
+    r5 = _mm256_permute2x128_si256(u1, u5, 0x31);					\
+    r6 = _mm256_permute2x128_si256(u2, u6, 0x31);					\
+    r7 = _mm256_permute2x128_si256(u3, u7, 0x31);					\
+  }
+
+__attribute__((target("avx2"))) static void j_rev_dct_avx2(DCTBLOCK data)
+{
+  __m256i i0, i1, i2, i3, i4, i5, i6, i7;
+  __m256i o0, o1, o2, o3, o4, o5, o6, o7;
+
+  i0 = _mm256_loadu_si256((const __m256i *)(data + DCTSIZE * 0));
+  i1 = _mm256_loadu_si256((const __m256i *)(data + DCTSIZE * 1));
+  i2 = _mm256_loadu_si256((const __m256i *)(data + DCTSIZE * 2));
+  i3 = _mm256_loadu_si256((const __m256i *)(data + DCTSIZE * 3));
+  i4 = _mm256_loadu_si256((const __m256i *)(data + DCTSIZE * 4));
+  i5 = _mm256_loadu_si256((const __m256i *)(data + DCTSIZE * 5));
+  i6 = _mm256_loadu_si256((const __m256i *)(data + DCTSIZE * 6));
+  i7 = _mm256_loadu_si256((const __m256i *)(data + DCTSIZE * 7));
+
+  /* Pass 1: process rows. */
+  V_TRANSPOSE8(i0, i1, i2, i3, i4, i5, i6, i7);
+#define PASS_SHIFT (CONST_BITS-PASS1_BITS)
+#include "jrevdct_pass.inc"
+#undef PASS_SHIFT
+
+  /* Pass 2: process columns. */
+  i0 = o0; i1 = o1; i2 = o2; i3 = o3; i4 = o4; i5 = o5; i6 = o6; i7 = o7;
+  V_TRANSPOSE8(i0, i1, i2, i3, i4, i5, i6, i7);
+#define PASS_SHIFT (CONST_BITS+PASS1_BITS+1)
+#include "jrevdct_pass.inc"
+#undef PASS_SHIFT
+
+  _mm256_storeu_si256((__m256i *)(data + DCTSIZE * 0), o0);
+  _mm256_storeu_si256((__m256i *)(data + DCTSIZE * 1), o1);
+  _mm256_storeu_si256((__m256i *)(data + DCTSIZE * 2), o2);
+  _mm256_storeu_si256((__m256i *)(data + DCTSIZE * 3), o3);
+  _mm256_storeu_si256((__m256i *)(data + DCTSIZE * 4), o4);
+  _mm256_storeu_si256((__m256i *)(data + DCTSIZE * 5), o5);
+  _mm256_storeu_si256((__m256i *)(data + DCTSIZE * 6), o6);
+  _mm256_storeu_si256((__m256i *)(data + DCTSIZE * 7), o7);
+}
+
+#undef VEC
+#undef V_ADD
+#undef V_SUB
+#undef V_MUL
+#undef V_SHL
+#undef V_DESCALE
+#undef V_TRANSPOSE8
+#endif
+
+#if defined(__SSE2__)
+static void (*j_rev_dct_impl)(DCTBLOCK) = j_rev_dct_sse2;
+#elif defined(__GNUC__) && (defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(__ALTIVEC__))
+static void (*j_rev_dct_impl)(DCTBLOCK) = j_rev_dct_vec;
+#else
+static void (*j_rev_dct_impl)(DCTBLOCK) = j_rev_dct_c;
+#endif
+
+void j_rev_dct_init(void)
+{
+#ifdef JREVDCT_HAVE_AVX2
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx2"))
+    j_rev_dct_impl = j_rev_dct_avx2;
+#endif
+}
+
+void j_rev_dct(DCTBLOCK data)
+{
+  j_rev_dct_impl(data);
+}
+
+/*
+ * Inverse DCT of a block whose AC coefficients are all zero; same result as
+ * j_rev_dct(), since every output of both passes reduces to the descaled DC term.
+ */
+
+void j_rev_dct_dc(DCTBLOCK data)
+{
+  const DCTELEM pass1 = (DCTELEM) DESCALE((int32) data[0] << CONST_BITS, CONST_BITS-PASS1_BITS);
+  const DCTELEM value = (DCTELEM) DESCALE((int32) pass1 << CONST_BITS, CONST_BITS+PASS1_BITS+1);
+  int i;
+
+  for (i = 0; i < DCTSIZE*DCTSIZE; i++)
+    data[i] = value;
+}
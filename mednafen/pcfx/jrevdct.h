@@ -10,7 +10,9 @@ extern "C" {
 typedef int32* DCTBLOCK;     
 typedef int32 DCTELEM;
 
+void j_rev_dct_init(void);	// Picks the fastest implementation the CPU supports.
 void j_rev_dct(DCTBLOCK data);
+void j_rev_dct_dc(DCTBLOCK data);	// For blocks with all AC coefficients zero.
 
 #ifdef __cplusplus
 }
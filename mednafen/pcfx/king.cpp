@@ -37,6 +37,10 @@
 #include <mmintrin.h>
 #endif
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include <assert.h>
 #include <math.h>
 
@@ -53,6 +57,10 @@
 #include "../sound/OwlResampler.h"
 #include "../video/surface.h"
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 /*
  SCSI Questions(this list needs to be revised more and merged into the issues list at the beginning of the file):
 
@@ -175,6 +183,12 @@ typedef struct
 
 static vce_rendercache_t vce_rendercache;
 
+// YUV + layer number for each 9-bit mixed VDC pixel(bit 8 = SPR), with palette_offset[0] already applied;
+// entries with a transparent(zero) low nibble are 0.  Kept in sync with palette_table_cache by RedoPaletteCache().
+static uint32 vdc_mix_lut[0x200];
+static uint16 vdc_mix_lut_poffset;
+static bool vdc_mix_lut_valid = false;
+
 static int32 scsicd_ne;
 
 enum
@@ -191,12 +205,48 @@ static int32 HPhaseCounter;
 static uint32 vdc_lb_pos;
 
 static MDFN_ALIGN(8) uint16 vdc_linebuffers[2][512];
-static MDFN_ALIGN(8) uint32 vdc_linebuffer[512];
-static MDFN_ALIGN(8) uint32 vdc_linebuffer_yuved[512];
-static MDFN_ALIGN(8) uint32 rainbow_linebuffer[256];
 
-// 8 * 2 for left + right padding for scrolling
-static MDFN_ALIGN(8) uint32 bg_linebuffer[256 + 8 + 8];
+//
+// Everything MixLayers() needs to produce one line of output.  With frame pipelining enabled, these are recorded
+// per-line into a frame description and mixed on the render thread while the next frame is being emulated.
+//
+typedef struct
+{
+ MDFN_ALIGN(8) uint32 vdc[512];
+ MDFN_ALIGN(8) uint32 vdc_yuved[512];
+ MDFN_ALIGN(8) uint32 rainbow[256];
+
+ // 8 * 2 for left + right padding for scrolling
+ MDFN_ALIGN(8) uint32 bg[256 + 8 + 8];
+
+ // VCE state latched at the end of the line
+ uint32 LayerPriority[8];
+ uint32 hindmost_color;	// palette_table_cache[0]
+ uint16 picture_mode;
+ uint16 CCR;
+ uint16 BLE;
+ uint16 SPBL;
+ uint16 coefficients[6];
+
+ uint16 target_line;	// Line in the output surface
+ bool dot_clock;
+ bool rainbow_off;	// RAINBOW layer disabled(or not fetched) for this line
+} king_line_t;
+
+typedef struct
+{
+ MDFN_Surface *surface;
+ uint32 line_count;
+ king_line_t lines[240];
+} king_frame_t;
+
+static king_line_t scratch_line;
+static king_line_t *cur_line = &scratch_line;
+
+static bool FramePipelining;
+static king_frame_t *PipeFrames[2];
+static king_frame_t *PipeCurFrame;	// Frame currently being recorded, NULL if pipelining is off.
+static unsigned PipeWhich;
 
 
 
@@ -352,6 +402,17 @@ static INLINE void RedoPaletteCache(int n)
 
  vce_rendercache.palette_table_cache[n] = 
  vce_rendercache.palette_table_cache[0x200 | n] = (Y << 16) | (U << 8) | (V << 0);
+
+ if(vdc_mix_lut_valid)
+ {
+  for(unsigned spr = 0; spr < 2; spr++)
+  {
+   const uint32 index = (n - (((vdc_mix_lut_poffset >> (spr * 8)) & 0xFF) << 1)) & 0x1FF;
+
+   if(index < 0x100 && (index & 0xF))
+    vdc_mix_lut[(spr << 8) | index] = vce_rendercache.palette_table_cache[n] | ((spr ? LAYER_VDC_SPR : LAYER_VDC_BG) << 28);
+  }
+ }
 }
 
 enum
@@ -494,6 +555,34 @@ uint8 KING_RB_Fetch(void)
  return(ret);
 }
 
+// Bulk counterparts of KING_RB_Fetch(): KING_RB_Peek() copies count bytes starting offset bytes past the
+// current read position without moving it, and KING_RB_Skip() advances the read position by count bytes.
+void KING_RB_Peek(uint8 *dest, uint32 offset, uint32 count)
+{
+ const uint32 pos = king->RAINBOWKRAMReadPos;
+ const uint32 start = (pos & 0x3FFFF) + offset;
+
+#ifndef MSB_FIRST
+ if(start + count <= 0x40000)
+ {
+  memcpy(dest, (const uint8 *)king->RainbowPagePtr + (start | (pos & 0x40000)), count);
+  return;
+ }
+#endif
+
+ for(uint32 i = 0; i < count; i++)
+ {
+  const uint32 p = ((start + i) & 0x3FFFF) | (pos & 0x40000);
+
+  dest[i] = king->RainbowPagePtr[(p >> 1) & 0x3FFFF] >> ((p & 1) * 8);
+ }
+}
+
+void KING_RB_Skip(uint32 count)
+{
+ king->RAINBOWKRAMReadPos = ((king->RAINBOWKRAMReadPos + count) & 0x3FFFF) | (king->RAINBOWKRAMReadPos & 0x40000);
+}
+
 static void DoRealDMA(uint8 db)
 {
  if(!king->DMATransferFlipFlop)
@@ -700,10 +789,15 @@ uint8 KING_Read8(const v810_timestamp_t timestamp, uint32 A)
  return KING_Read16(timestamp, A & ~1) >> ((A & 1) * 8);
 }
 
+static void PipeSubmitFrame(void);
+
 void KING_EndFrame(v810_timestamp_t timestamp)
 {
  PCFX_SetEvent(PCFX_EVENT_KING, KING_Update(timestamp));
  scsicd_ne = SCSICD_Run(timestamp);
+
+ if(PipeCurFrame)
+  PipeSubmitFrame();
 }
 
 void KING_ResetTS(v810_timestamp_t ts_base)
@@ -1369,6 +1463,9 @@ void KING_Write16(const v810_timestamp_t timestamp, uint32 A, uint16 V)
 		case 0x50: 
 			   if(!msh)
 			   {
+			    // SoundBox runs ADPCM ahead in batches, so bring it up to date before changing what it's playing.
+			    SoundBox_ADPCMUpdate(timestamp);
+
 			    for(int ch = 0; ch < 2; ch++)
 			    {
 			     if(!(king->ADPCMControl & (1 << ch)) && (V & (1 << ch)))
@@ -1379,6 +1476,7 @@ void KING_Write16(const v810_timestamp_t timestamp, uint32 A, uint16 V)
 			    king->ADPCMControl = V; 
 			    RedoKINGIRQCheck();
 			    SoundBox_SetKINGADPCMControl(king->ADPCMControl);
+			    PCFX_SetEvent(PCFX_EVENT_ADPCM, SoundBox_ADPCMUpdate(timestamp));
 			   }
 			   break;
 
@@ -1449,9 +1547,186 @@ uint16 KING_GetADPCMHalfWord(int ch)
  return(ret);
 }
 
+// Fetches up to "count" halfwords in a row, stopping early after a fetch that leaves the channel disabled.  Returns the
+// number fetched.
+uint32 KING_GetADPCMHalfWords(int ch, uint16 *dest, uint32 count)
+{
+ uint32 n = 0;
+
+ do
+ {
+  dest[n++] = KING_GetADPCMHalfWord(ch);
+ } while(n < count && (king->ADPCMControl & (1 << ch)));
+
+ return(n);
+}
+
 static uint32 HighDotClockWidth;
 extern RavenBuffer* FXCDDABufs[2]; // FIXME, externals are evil!
 
+static void MixLayers(const king_line_t *lr, bpp_t *target);
+
+//
+// Frame pipelining: the emulation thread records each frame's lines into PipeFrames[PipeWhich] and hands it off to the
+// render thread at the end of the frame, which runs MixLayers() on it while the next frame is being emulated.
+//
+#ifdef HAVE_THREADS
+static sthread_t *RenderThread;
+static slock_t *RenderMutex;
+static scond_t *RenderCond;
+static scond_t *RenderDoneCond;
+static king_frame_t *RenderPending;	// Frame handed off to the render thread, NULL when it's idle.
+static bool RenderExit;
+
+static void RenderThreadStart(void *arg)
+{
+ slock_lock(RenderMutex);
+
+ for(;;)
+ {
+  while(!RenderPending && !RenderExit)
+   scond_wait(RenderCond, RenderMutex);
+
+  if(RenderExit)
+   break;
+
+  king_frame_t *frame = RenderPending;
+  slock_unlock(RenderMutex);
+
+  for(uint32 i = 0; i < frame->line_count; i++)
+  {
+   const king_line_t *lr = &frame->lines[i];
+
+   MixLayers(lr, frame->surface->pixels + frame->surface->pitch32 * lr->target_line);
+  }
+
+  slock_lock(RenderMutex);
+  RenderPending = NULL;
+  scond_signal(RenderDoneCond);
+ }
+
+ slock_unlock(RenderMutex);
+}
+#endif
+
+static void PipeKill(void)
+{
+#ifdef HAVE_THREADS
+ if(RenderThread)
+ {
+  slock_lock(RenderMutex);
+  RenderExit = true;
+  scond_signal(RenderCond);
+  slock_unlock(RenderMutex);
+
+  sthread_join(RenderThread);
+  RenderThread = NULL;
+ }
+
+ if(RenderMutex)
+ {
+  slock_free(RenderMutex);
+  RenderMutex = NULL;
+ }
+
+ if(RenderCond)
+ {
+  scond_free(RenderCond);
+  RenderCond = NULL;
+ }
+
+ if(RenderDoneCond)
+ {
+  scond_free(RenderDoneCond);
+  RenderDoneCond = NULL;
+ }
+#endif
+
+ for(unsigned i = 0; i < 2; i++)
+ {
+  if(PipeFrames[i])
+  {
+   free(PipeFrames[i]);
+   PipeFrames[i] = NULL;
+  }
+ }
+
+ FramePipelining = false;
+ PipeCurFrame = NULL;
+}
+
+static void PipeInit(void)
+{
+ FramePipelining = false;
+ PipeCurFrame = NULL;
+ PipeWhich = 0;
+
+#ifdef HAVE_THREADS
+ if(!MDFN_GetSettingB("pcfx.frame_pipelining"))
+  return;
+
+ for(unsigned i = 0; i < 2; i++)
+ {
+  if(!(PipeFrames[i] = (king_frame_t*)calloc(1, sizeof(king_frame_t))))
+  {
+   PipeKill();
+   return;
+  }
+ }
+
+ RenderMutex = slock_new();
+ RenderCond = scond_new();
+ RenderDoneCond = scond_new();
+ RenderPending = NULL;
+ RenderExit = false;
+
+ if(!(RenderThread = sthread_create(RenderThreadStart, NULL)))
+ {
+  PipeKill();
+  return;
+ }
+
+ FramePipelining = true;
+#endif
+}
+
+static void PipeSubmitFrame(void)
+{
+#ifdef HAVE_THREADS
+ slock_lock(RenderMutex);
+
+ while(RenderPending)
+  scond_wait(RenderDoneCond, RenderMutex);
+
+ RenderPending = PipeCurFrame;
+ scond_signal(RenderCond);
+ slock_unlock(RenderMutex);
+#endif
+
+ PipeCurFrame = NULL;
+ PipeWhich ^= 1;
+}
+
+void KING_WaitFrame(void)
+{
+#ifdef HAVE_THREADS
+ if(!FramePipelining)
+  return;
+
+ slock_lock(RenderMutex);
+
+ while(RenderPending)
+  scond_wait(RenderDoneCond, RenderMutex);
+
+ slock_unlock(RenderMutex);
+#endif
+}
+
+bool KING_GetFramePipelining(void)
+{
+ return FramePipelining;
+}
+
 bool KING_Init(void)
 {
  if(!(king = (king_t*)calloc(1, sizeof(king_t))))
@@ -1518,11 +1793,15 @@ bool KING_Init(void)
 
  SCSICD_Init(3, FXCDDABufs[0]->Buf(), FXCDDABufs[1]->Buf(), 153600 * MDFN_GetSettingUI("pcfx.cdspeed"), 21477273, KING_CDIRQ, KING_StuffSubchannels);
 
+ PipeInit();
+
  return(1);
 }
 
 void KING_Close(void)
 {
+ PipeKill();
+
  if(king)
  {
   free(king);
@@ -1535,6 +1814,8 @@ void KING_Close(void)
 void KING_Reset(const v810_timestamp_t timestamp)
 {
  KING_Update(timestamp);
+ SoundBox_ADPCMUpdate(timestamp);
+ RAINBOW_WaitDecode();
 
  memset(&fx_vce, 0, sizeof(fx_vce));
 
@@ -1558,10 +1839,8 @@ void KING_Reset(const v810_timestamp_t timestamp)
  vdc_lb_pos = 0;
 
  memset(vdc_linebuffers, 0, sizeof(vdc_linebuffers));
- memset(vdc_linebuffer, 0, sizeof(vdc_linebuffer));
- memset(vdc_linebuffer_yuved, 0, sizeof(vdc_linebuffer_yuved));
- memset(rainbow_linebuffer, 0, sizeof(rainbow_linebuffer));
- memset(bg_linebuffer, 0, sizeof(bg_linebuffer));
+ memset(&scratch_line, 0, sizeof(scratch_line));
+ cur_line = &scratch_line;
 
 
  king->dma_cycle_counter = 0x7FFFFFFF;
@@ -2119,6 +2398,14 @@ void KING_StartFrame(VDC **arg_vdc_chips, EmulateSpecStruct *espec)	//MDFN_Surfa
  ::LineWidths = espec->LineWidths;
  ::skip = espec->skip;
 
+ cur_line = &scratch_line;
+ if(FramePipelining)
+ {
+  PipeCurFrame = PipeFrames[PipeWhich];
+  PipeCurFrame->surface = espec->surface;
+  PipeCurFrame->line_count = 0;
+ }
+
  // For the case of interlaced mode(clear ~0 state)
  LineWidths[0] = 0;
 
@@ -2169,6 +2456,7 @@ static void DrawActive(void)
     king->RAINBOWBlockCount = king->RAINBOWTransferBlockCount;
     if(king->RAINBOWBlockCount)
     {
+     RAINBOW_WaitDecode();
      king->RAINBOWKRAMReadPos = king->RAINBOWKRAMA << 1;
      FirstDecode = TRUE;
     }
@@ -2194,7 +2482,7 @@ static void DrawActive(void)
    }
   }
 
-  rb_type = RAINBOW_FetchRaster(skip ? NULL : rainbow_linebuffer, LAYER_RAINBOW << 28, &vce_rendercache.palette_table_cache[((fx_vce.palette_offset[3] >> 0) & 0xFF) << 1]);
+  rb_type = RAINBOW_FetchRaster(skip ? NULL : cur_line->rainbow, LAYER_RAINBOW << 28, &vce_rendercache.palette_table_cache[((fx_vce.palette_offset[3] >> 0) & 0xFF) << 1]);
 
   king->RAINBOWStartPending = FALSE;
  } // end   if(fx_vce.raster_counter < 262)
@@ -2219,8 +2507,8 @@ static void DrawActive(void)
      {
       for(int x = 0; x < 256; x++)
       {
-       if(!(rainbow_linebuffer[x] & 0xFFFFFF))
-        rainbow_linebuffer[x] = 0;
+       if(!(cur_line->rainbow[x] & 0xFFFFFF))
+        cur_line->rainbow[x] = 0;
       }
      }
      else if(ymin == ymax && umin == umax && vmin == vmax)
@@ -2229,8 +2517,8 @@ static void DrawActive(void)
 
       for(int x = 0; x < 256; x++)
       {
-       if((rainbow_linebuffer[x] & 0xFFFFFF) == compare_color)
-        rainbow_linebuffer[x] = 0;
+       if((cur_line->rainbow[x] & 0xFFFFFF) == compare_color)
+        cur_line->rainbow[x] = 0;
       }
      }
      else if(ymin <= ymax && umin <= umax && vmin <= vmax)
@@ -2242,7 +2530,7 @@ static void DrawActive(void)
 
       for(int x = 0; x < 256; x++)
       {
-       const uint32 pixel = rainbow_linebuffer[x];
+       const uint32 pixel = cur_line->rainbow[x];
        const uint32 yv = pixel & 0xFF00FF;
        const uint32 u = pixel & 0x00FF00;
        uint32 testie;
@@ -2251,7 +2539,7 @@ static void DrawActive(void)
        testie |= ((u - u_min_sub) | (u + u_max_add)) & 0x00FF00FF;
 
        if(!testie)
-        rainbow_linebuffer[x] = 0;
+        cur_line->rainbow[x] = 0;
       }
      }
     }
@@ -2263,7 +2551,7 @@ static void DrawActive(void)
         0 = Hidden
     */
 
-   MDFN_FastU32MemsetM8(bg_linebuffer + 8, 0, 256);
+   MDFN_FastU32MemsetM8(cur_line->bg + 8, 0, 256);
 
     // Only bother to draw the BGs if the microprogram is enabled.
    if(king->MPROGControl & 0x1)
@@ -2283,9 +2571,9 @@ static void DrawActive(void)
 
        // TODO/FIXME: TEST MORE
        if(CanDrawBG_Fast(x)) // && (rand() & 1))
-	DrawBG_Fast(bg_linebuffer, x);
+	DrawBG_Fast(cur_line->bg, x);
        else
-        DrawBG(bg_linebuffer, x, 0);
+        DrawBG(cur_line->bg, x, 0);
       }
      }
     }
@@ -2295,17 +2583,81 @@ static void DrawActive(void)
  } // end if(fx_vce.raster_counter >= 22 && fx_vce.raster_counter < 262)
 }
 
-static INLINE void VDC_PIXELMIX(bool SPRCOMBO_ON, bool BGCOMBO_ON)
+static void RebuildVDCMixLUT(void)
 {
-    static const uint32 vdc_layer_num[2] = { LAYER_VDC_BG << 28, LAYER_VDC_SPR << 28};
-    const uint32 vdc_poffset[2] = {
+ static const uint32 vdc_layer_num[2] = { LAYER_VDC_BG << 28, LAYER_VDC_SPR << 28};
+ const uint32 vdc_poffset[2] = {
                                 (((uint32)fx_vce.palette_offset[0] >> 0) & 0xFF) << 1, // BG
                                 (((uint32)fx_vce.palette_offset[0] >> 8) & 0xFF) << 1 // SPR
                                };
 
+ for(unsigned i = 0; i < 0x200; i++)
+ {
+  vdc_mix_lut[i] = 0;
+  if(i & 0xF)
+   vdc_mix_lut[i] = vce_rendercache.palette_table_cache[(i & 0xFF) + vdc_poffset[(i >> 8) & 1]] | vdc_layer_num[(i >> 8) & 1];
+ }
+
+ vdc_mix_lut_poffset = fx_vce.palette_offset[0];
+ vdc_mix_lut_valid = true;
+}
+
+static INLINE void VDC_PIXELMIX(bool SPRCOMBO_ON, bool BGCOMBO_ON)
+{
     const uint_fast16_t width = fx_vce.dot_clock ? 342 : 256; // 342, not 341, to prevent garbage pixels in high dot clock mode.
+    int x = 0;
+
+    if(!vdc_mix_lut_valid || vdc_mix_lut_poffset != fx_vce.palette_offset[0])
+     RebuildVDCMixLUT();
 
-    for(int x = 0; x < width; x++)
+#if defined(__SSE2__)
+    {
+     const __m128i lo_nib = _mm_set1_epi16(0xF);
+     const __m128i combo_mask = _mm_set1_epi16(0x18F);
+     const __m128i combo_thresh = _mm_set1_epi16(0x180);
+     const __m128i spr_bit = _mm_set1_epi16(0x100);
+     const __m128i zero = _mm_setzero_si128();
+     MDFN_ALIGN(16) uint16 mixed[8];
+
+     for(; x < (int)(width & ~7); x += 8)
+     {
+      const __m128i z0 = _mm_loadu_si128((const __m128i *)&vdc_linebuffers[0][x]);
+      const __m128i z1 = _mm_loadu_si128((const __m128i *)&vdc_linebuffers[1][x]);
+      const __m128i z1_opaque = _mm_xor_si128(_mm_cmpeq_epi16(_mm_and_si128(z1, lo_nib), zero), _mm_cmpeq_epi16(zero, zero));
+      __m128i tmp = _mm_or_si128(_mm_and_si128(z1_opaque, z1), _mm_andnot_si128(z1_opaque, z0));
+
+      if(SPRCOMBO_ON || BGCOMBO_ON)
+      {
+       const __m128i combo = _mm_or_si128(_mm_and_si128(z1, lo_nib), _mm_slli_epi16(_mm_and_si128(z0, lo_nib), 4));
+
+       /* BG combination  */
+       if(BGCOMBO_ON)
+       {
+        const __m128i sel = _mm_cmpgt_epi16(_mm_and_si128(_mm_xor_si128(z1, spr_bit), combo_mask), combo_thresh);
+
+        tmp = _mm_or_si128(_mm_and_si128(sel, combo), _mm_andnot_si128(sel, tmp));
+       }
+
+       /* SPR combination, takes precedence over the BG combination */
+       if(SPRCOMBO_ON)
+       {
+        const __m128i sel = _mm_cmpgt_epi16(_mm_and_si128(z1, combo_mask), combo_thresh);
+
+        tmp = _mm_or_si128(_mm_and_si128(sel, _mm_or_si128(combo, spr_bit)), _mm_andnot_si128(sel, tmp));
+       }
+      }
+
+      _mm_storeu_si128((__m128i *)&cur_line->vdc[x + 0], _mm_unpacklo_epi16(tmp, zero));
+      _mm_storeu_si128((__m128i *)&cur_line->vdc[x + 4], _mm_unpackhi_epi16(tmp, zero));
+
+      _mm_store_si128((__m128i *)mixed, _mm_and_si128(tmp, _mm_set1_epi16(0x1FF)));
+      for(int i = 0; i < 8; i++)
+       cur_line->vdc_yuved[x + i] = vdc_mix_lut[mixed[i]];
+     }
+    }
+#endif
+
+    for(; x < width; x++)
     {
      const uint32 zort[2] = { vdc_linebuffers[0][x], vdc_linebuffers[1][x] };
      uint32 tmp_pixel;
@@ -2319,10 +2671,8 @@ static INLINE void VDC_PIXELMIX(bool SPRCOMBO_ON, bool BGCOMBO_ON)
      else
       tmp_pixel = (zort[1] & 0xF) ? zort[1] : zort[0];
 
-     vdc_linebuffer[x] = tmp_pixel;
-     vdc_linebuffer_yuved[x] = 0;
-     if(tmp_pixel & 0xF)
-      vdc_linebuffer_yuved[x] = vce_rendercache.palette_table_cache[(tmp_pixel & 0xFF) + vdc_poffset[(tmp_pixel >> 8) & 1]] | vdc_layer_num[(tmp_pixel >> 8) & 1];
+     cur_line->vdc[x] = tmp_pixel;
+     cur_line->vdc_yuved[x] = vdc_mix_lut[tmp_pixel & 0x1FF];
     }
 }
 
@@ -2332,7 +2682,7 @@ static void MixVDC(void)
     // Optimization for when both layers are disabled in the VCE.
     if(!vce_rendercache.LayerPriority[LAYER_VDC_BG] && !vce_rendercache.LayerPriority[LAYER_VDC_SPR])
     {
-     MDFN_FastU32MemsetM8(vdc_linebuffer_yuved, 0, 512);
+     MDFN_FastU32MemsetM8(cur_line->vdc_yuved, 0, 512);
     }
     else switch(fx_vce.picture_mode & 0xC0)
     {
@@ -2344,31 +2694,29 @@ static void MixVDC(void)
 }
 
 
-static void MixLayers(void)
+static void MixLayers(const king_line_t *lr, bpp_t *target)
 {
-   bpp_t *pXBuf = surface->pixels;
-
     // Now we have to mix everything together... I'm scared, mommy.
-    // We have, vdc_linebuffer[0] and bg_linebuffer
+    // We have, lr->vdc_yuved, lr->bg and lr->rainbow
     // Which layer is specified in bits 28-31(check the enum earlier on)
     uint32 priority_remap[8];
     uint32 ble_cache[8];
     bool ble_cache_any = FALSE;
 
     for(int n = 0; n < 8; n++)
-     priority_remap[n] = vce_rendercache.LayerPriority[n];
+     priority_remap[n] = lr->LayerPriority[n];
 
     // Rainbow layer disabled?
-    if(rb_type == -1 || RAINBOWLayerDisable)
+    if(lr->rainbow_off)
      priority_remap[LAYER_RAINBOW] = 0;
 
     ble_cache[LAYER_NONE] = 0;
     for(int x = 0; x < 4; x++)
-     ble_cache[LAYER_BG0 + x] = (vce_rendercache.BLE >> (4 + x * 2)) & 0x3;
+     ble_cache[LAYER_BG0 + x] = (lr->BLE >> (4 + x * 2)) & 0x3;
 
-    ble_cache[LAYER_VDC_BG] = (vce_rendercache.BLE >> 0) & 0x3;
-    ble_cache[LAYER_VDC_SPR] = (vce_rendercache.BLE >> 2) & 0x3;
-    ble_cache[LAYER_RAINBOW] = (vce_rendercache.BLE >> 12) & 0x3;
+    ble_cache[LAYER_VDC_BG] = (lr->BLE >> 0) & 0x3;
+    ble_cache[LAYER_VDC_SPR] = (lr->BLE >> 2) & 0x3;
+    ble_cache[LAYER_RAINBOW] = (lr->BLE >> 12) & 0x3;
 
     for(int x = 0; x < 8; x++)
      if(ble_cache[x])
@@ -2384,23 +2732,17 @@ static void MixLayers(void)
 
     for(int x = 0; x < 3; x++)
     {
-     coeff_cache_y_fore[x] = vce_rendercache.coefficient_mul_table_y[(vce_rendercache.coefficients[x * 2 + 0] >> 8) & 0xF];
-     coeff_cache_u_fore[x] = vce_rendercache.coefficient_mul_table_uv[(vce_rendercache.coefficients[x * 2 + 0] >> 4) & 0xF];
-     coeff_cache_v_fore[x] = vce_rendercache.coefficient_mul_table_uv[(vce_rendercache.coefficients[x * 2 + 0] >> 0) & 0xF];
+     coeff_cache_y_fore[x] = vce_rendercache.coefficient_mul_table_y[(lr->coefficients[x * 2 + 0] >> 8) & 0xF];
+     coeff_cache_u_fore[x] = vce_rendercache.coefficient_mul_table_uv[(lr->coefficients[x * 2 + 0] >> 4) & 0xF];
+     coeff_cache_v_fore[x] = vce_rendercache.coefficient_mul_table_uv[(lr->coefficients[x * 2 + 0] >> 0) & 0xF];
 
-     coeff_cache_y_back[x] = vce_rendercache.coefficient_mul_table_y[(vce_rendercache.coefficients[x * 2 + 1] >> 8) & 0xF];
-     coeff_cache_u_back[x] = vce_rendercache.coefficient_mul_table_uv[(vce_rendercache.coefficients[x * 2 + 1] >> 4) & 0xF];
-     coeff_cache_v_back[x] = vce_rendercache.coefficient_mul_table_uv[(vce_rendercache.coefficients[x * 2 + 1] >> 0) & 0xF];
+     coeff_cache_y_back[x] = vce_rendercache.coefficient_mul_table_y[(lr->coefficients[x * 2 + 1] >> 8) & 0xF];
+     coeff_cache_u_back[x] = vce_rendercache.coefficient_mul_table_uv[(lr->coefficients[x * 2 + 1] >> 4) & 0xF];
+     coeff_cache_v_back[x] = vce_rendercache.coefficient_mul_table_uv[(lr->coefficients[x * 2 + 1] >> 0) & 0xF];
     }
 
-    bpp_t *target;
     uint32 BPC_Cache = (LAYER_NONE << 28); // Backmost pixel color(cache)
 
-    if(fx_vce.frame_interlaced)
-     target = pXBuf + surface->pitch32 * ((fx_vce.raster_counter - 22) * 2 + fx_vce.odd_field);
-    else
-     target = pXBuf + surface->pitch32 * (fx_vce.raster_counter - 22);
-    
 
     // If at least one layer is enabled with the HuC6261, hindmost color is palette[0]
     // If no layers are on, this color is black.
@@ -2411,13 +2753,13 @@ static void MixLayers(void)
     //  or if it just outputs black.
     // TODO:  See if enabling front/back cellophane in high dot-clock mode will set the hindmost color, even though the cellophane color mixing
     //  is disabled in high dot-clock mode.
-    if(vce_rendercache.picture_mode & 0x7F00)
-     BPC_Cache |= vce_rendercache.palette_table_cache[0];
+    if(lr->picture_mode & 0x7F00)
+     BPC_Cache |= lr->hindmost_color;
     else			
      BPC_Cache |= 0x008080;
 
 #define DOCELLO(pixpoo) \
-	if((pixel[pixpoo] >> 28) != LAYER_VDC_SPR || ((vce_rendercache.SPBL >> ((vdc_linebuffer[x] & 0xF0)>> 4)) & 1))	\
+	if((pixel[pixpoo] >> 28) != LAYER_VDC_SPR || ((lr->SPBL >> ((lr->vdc[x] & 0xF0)>> 4)) & 1))	\
         {	\
          int which_co = (ble_cache[pixel[pixpoo] >> 28] - 1);	\
          uint8 back_y = coeff_cache_y_back[which_co][(zeout >> 16) & 0xFF];	\
@@ -2442,9 +2784,9 @@ static void MixLayers(void)
       { uint32 pixel[4];	\
       uint32 prio[3];	\
       uint32 zeout = BPC_Cache;	\
-      prio[0] = priority_remap[vdc_linebuffer_yuved[index_341] >> 28];  \
-      prio[1] = priority_remap[(bg_linebuffer + 8)[index_256] >> 28];	\
-      prio[2] = priority_remap[rainbow_linebuffer[index_256] >> 28];	\
+      prio[0] = priority_remap[lr->vdc_yuved[index_341] >> 28];  \
+      prio[1] = priority_remap[(lr->bg + 8)[index_256] >> 28];	\
+      prio[2] = priority_remap[lr->rainbow[index_256] >> 28];	\
       pixel[0] = 0;	\
       pixel[1] = 0;	\
       pixel[2] = 0;	\
@@ -2452,9 +2794,9 @@ static void MixLayers(void)
        uint8 pi0 = VCEPrioMap[prio[0]][prio[1]][prio[2]][0];	\
        uint8 pi1 = VCEPrioMap[prio[0]][prio[1]][prio[2]][1];	\
        uint8 pi2 = VCEPrioMap[prio[0]][prio[1]][prio[2]][2];	\
-       /*assert(pi0 == 3 || !pixel[pi0]);*/ pixel[pi0] = vdc_linebuffer_yuved[index_341]; 	\
-       /*assert(pi1 == 3 || !pixel[pi1]);*/ pixel[pi1] = (bg_linebuffer + 8)[index_256];	\
-       /*assert(pi2 == 3 || !pixel[pi2]);*/ pixel[pi2] = rainbow_linebuffer[index_256];		\
+       /*assert(pi0 == 3 || !pixel[pi0]);*/ pixel[pi0] = lr->vdc_yuved[index_341]; 	\
+       /*assert(pi1 == 3 || !pixel[pi1]);*/ pixel[pi1] = (lr->bg + 8)[index_256];	\
+       /*assert(pi2 == 3 || !pixel[pi2]);*/ pixel[pi2] = lr->rainbow[index_256];		\
       }
 
 #define LAYER_MIX_FINAL_NOCELLO	\
@@ -2564,15 +2906,38 @@ static void MixLayers(void)
     #define YUV888_TO_xxx YUV888_TO_PF
     #include "king_mix_body.inc"
     #undef YUV888_TO_xxx
+}
+
+// Latches the VCE state MixLayers() depends on into the current line, and updates the line width information.
+static void FinishLine(void)
+{
+    king_line_t *lr = cur_line;
+
+    for(int n = 0; n < 8; n++)
+     lr->LayerPriority[n] = vce_rendercache.LayerPriority[n];
+
+    lr->hindmost_color = vce_rendercache.palette_table_cache[0];
+    lr->picture_mode = vce_rendercache.picture_mode;
+    lr->CCR = vce_rendercache.CCR;
+    lr->BLE = vce_rendercache.BLE;
+    lr->SPBL = vce_rendercache.SPBL;
+
+    for(int i = 0; i < 6; i++)
+     lr->coefficients[i] = vce_rendercache.coefficients[i];
+
+    if(fx_vce.frame_interlaced)
+     lr->target_line = (fx_vce.raster_counter - 22) * 2 + fx_vce.odd_field;
+    else
+     lr->target_line = fx_vce.raster_counter - 22;
+
+    lr->dot_clock = fx_vce.dot_clock;
+    lr->rainbow_off = (rb_type == -1 || RAINBOWLayerDisable);
 
     DisplayRect->w = fx_vce.dot_clock ? HighDotClockWidth : 243;
     DisplayRect->x = 0;
 
 	// FIXME
-    if(fx_vce.frame_interlaced)
-     LineWidths[(fx_vce.raster_counter - 22) * 2 + fx_vce.odd_field] = DisplayRect->w;
-    else
-     LineWidths[fx_vce.raster_counter - 22] = DisplayRect->w;
+    LineWidths[lr->target_line] = DisplayRect->w;
 }
 
 static INLINE void RunVDCs(const int master_cycles, uint16 *pixels0, uint16 *pixels1)
@@ -2631,6 +2996,11 @@ static void MDFN_FASTCALL KING_RunGfx(int32 clocks)
     case HPHASE_ACTIVE: vdc_lb_pos = 0;
 			fx_vce.in_hblank = false;
 			DoHBlankVCECaching();
+
+			cur_line = &scratch_line;
+			if(PipeCurFrame && !skip && fx_vce.raster_counter >= 22 && fx_vce.raster_counter < 262 && PipeCurFrame->line_count < 240)
+			 cur_line = &PipeCurFrame->lines[PipeCurFrame->line_count];
+
 			DrawActive();
 			HPhaseCounter += 1024;
 			break;
@@ -2641,7 +3011,12 @@ static void MDFN_FASTCALL KING_RunGfx(int32 clocks)
                          if(fx_vce.raster_counter >= 22 && fx_vce.raster_counter < 262)
                          {
                           MixVDC();
-                          MixLayers();
+                          FinishLine();
+
+                          if(cur_line != &scratch_line)
+                           PipeCurFrame->line_count++;
+                          else
+                           MixLayers(cur_line, surface->pixels + surface->pitch32 * cur_line->target_line);
                          }
                         }
 			fx_vce.in_hblank = true;
@@ -2714,6 +3089,9 @@ static void MDFN_FASTCALL KING_RunGfx(int32 clocks)
 
 void KING_SetPixelFormat(const MDFN_PixelFormat &format) 
 {
+ // The render thread uses the lookup tables rebuilt below.
+ KING_WaitFrame();
+
  rs = format.Rshift;
  gs = format.Gshift;
  bs = format.Bshift;
@@ -2741,6 +3119,8 @@ void KING_SetLayerEnableMask(uint64 mask)
 
 int KING_StateAction(StateMem *sm, int load, int data_only)
 {
+ RAINBOW_WaitDecode();
+
  SFORMAT KINGStateRegs[] =
  {
   SFVARN(king->AR, "AR"),
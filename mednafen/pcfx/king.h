@@ -16,10 +16,13 @@ void KING_Close(void);
 void KING_Reset(const v810_timestamp_t timestamp);
 
 uint16 KING_GetADPCMHalfWord(int ch);
+uint32 KING_GetADPCMHalfWords(int ch, uint16 *dest, uint32 count);
 
 uint8 KING_MemPeek(uint32 A);
 
 uint8 KING_RB_Fetch();
+void KING_RB_Peek(uint8 *dest, uint32 offset, uint32 count);
+void KING_RB_Skip(uint32 count);
 
 void KING_SetLayerEnableMask(uint64 mask);
 
@@ -34,5 +37,9 @@ void KING_SetLogFunc(void (*logfunc)(const char *, const char *, ...));
 void KING_EndFrame(v810_timestamp_t timestamp);
 void KING_ResetTS(v810_timestamp_t ts_base);
 
+// Frame pipelining; KING_WaitFrame() blocks until the render thread has finished the last frame handed to it.
+bool KING_GetFramePipelining(void);
+void KING_WaitFrame(void);
+
 v810_timestamp_t MDFN_FASTCALL KING_Update(const v810_timestamp_t timestamp);
 #endif
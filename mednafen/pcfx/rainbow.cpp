@@ -24,8 +24,17 @@
 #include "jrevdct.h"
 
 #include "../clamp.h"
+#include "../mednafen-endian.h"
 #include "../state_helpers.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 static bool ChromaIP;	// Bilinearly interpolate chroma channel
 
 /* Y = luminance/luma, UV = chrominance/chroma */
@@ -42,6 +51,8 @@ typedef struct
 {
         uint8 *lut;             // LUT for getting the code.
         uint8 *lut_bits;        // Bit count for the code
+        uint32 *fast;           // Whole symbol for short codes: bits 0-4 = code + value bit count(0 = not covered),
+                                // bits 8-11 = zero run, bits 16-31 = value(sign-extended).
 } HuffmanQuickLUT;
 
 /* Luma DC Huffman tables */
@@ -247,11 +258,15 @@ static void KillHuffmanLUT(HuffmanQuickLUT *qlut)
  if(qlut->lut_bits)
   free(qlut->lut_bits);
 
+ if(qlut->fast)
+  free(qlut->fast);
+
  qlut->lut = NULL;
  qlut->lut_bits = NULL;
+ qlut->fast = NULL;
 }
 
-static bool BuildHuffmanLUT(const HuffmanTable *table, HuffmanQuickLUT *qlut, const int bitmax)
+static bool BuildHuffmanLUT(const HuffmanTable *table, HuffmanQuickLUT *qlut, const int bitmax, const bool is_ac)
 {
  // TODO: Allocate only (1 << bitmax) entries.
  // TODO: What should we set invalid bitsequences/entries to? 0? ~0?  Something else?
@@ -281,6 +296,53 @@ static bool BuildHuffmanLUT(const HuffmanTable *table, HuffmanQuickLUT *qlut, co
   }
  }
 
+ //
+ // When the code and the value bits following it both fit in the bitmax-bit peek window, the whole symbol
+ // can be decoded with one lookup.  For AC, the code is (zero run << 4) | value bits; for DC, codes >= 0xF
+ // are special(escape/quantizer change) and are left to the slow path.
+ //
+ if(!(qlut->fast = (uint32 *)calloc(1 << 12, sizeof(uint32))))
+  return(FALSE);
+
+ for(int index = 0; index < (1 << bitmax); index++)
+ {
+  const unsigned int code_bits = qlut->lut_bits[index];
+  const unsigned int code = qlut->lut[index];
+  unsigned int value_bits, zeroes;
+  int32 value;
+
+  if(is_ac && (index & 0xF80) == 0xF80)
+  {
+   qlut->fast[index] = 5;
+   continue;
+  }
+
+  if(!code_bits)
+   continue;
+
+  if(is_ac)
+  {
+   value_bits = code & 0xF;
+   zeroes = code >> 4;
+  }
+  else
+  {
+   if(code >= 0xF)
+    continue;
+   value_bits = code;
+   zeroes = 0;
+  }
+
+  if(code_bits + value_bits > (unsigned int)bitmax)
+   continue;
+
+  value = (index >> (bitmax - code_bits - value_bits)) & ((1 << value_bits) - 1);
+  if(value_bits && value < (1 << (value_bits - 1)))
+   value += 1 - (1 << value_bits);
+
+  qlut->fast[index] = (code_bits + value_bits) | (zeroes << 8) | ((uint32)(uint16)value << 16);
+ }
+
  return(TRUE);
 }
 
@@ -291,34 +353,147 @@ static uint32 QuantTables[2][64], QuantTablesBase[2][64];	// 0 = Y, 1 = UV
 
 static uint32 DecodeBufferWhichRead;
 
+//
+// YUV lines that have been read out are logically cleared to 0, but rather than actually clearing them, they're flagged
+// here(bit n = line n), and RAINBOW_FetchRaster() reads them as ZeroLine.  A decode that writes every pixel just drops the
+// flags; anything else calls FlushLineClears() first to do the clearing for real.
+//
+static uint16 LineClears[2];
+static const uint32 ZeroLine[256] = { 0 };
+
+static void FlushLineClears(const int which)
+{
+ for(unsigned int line = 0; line < 16; line++)
+ {
+  if(LineClears[which] & (1 << line))
+   memset(&DecodeBuffer[which][line * 256 * 4], 0, 256 * 4);
+ }
+
+ LineClears[which] = 0;
+}
+
 static int32 RasterReadPos;
 static uint16 Control;
 static uint16 NullRunY, NullRunU, NullRunV, HSync;
 static uint16 HScroll;
 
-static uint32 bits_buffer;
+//
+// The bit reader works from the block's data with the 0xFF stuffing bytes already removed.  InitBits() copies the most
+// KRAM the block could take up(every byte stuffed) in one go, so that the decode itself doesn't touch KING at all and can
+// run on the decode thread.  SyncBits() works out how far KRAM's read position would have advanced fetching a byte at a
+// time with KING_RB_Fetch(), and RAINBOW_WaitDecode() applies it.
+//
+static uint8 bits_raw[0x8000 * 2 + 64];	// Block data as it sits in KRAM
+static uint32 bits_raw_consumed;	// KRAM bytes a byte-at-a-time reader would have fetched, set by SyncBits()
+static uint8 bits_stream[0x8000 + 16];	// Destuffed data, zero-padded after the end of the block.
+static uint32 bits_stream_total;	// Bytes in the block
+static uint32 bits_stream_len;		// Bytes destuffed so far
+static uint32 bits_stream_raw;		// KRAM bytes consumed by destuffing so far
+static bool bits_stream_skipnext;	// Last KRAM byte destuffed was 0xFF, skip the next one.
+static uint32 bits_stream_pos;		// Next byte to go into bits_buffer
+
+static uint64 bits_buffer;
 static uint32 bits_buffered_bits;
-static int32 bits_bytes_left;
+static uint32 bits_needed_max;		// Bits a byte-at-a-time reader would have fetched.
 
 static void InitBits(int32 bcount)
 {
- bits_bytes_left = bcount;
+ bits_stream_total = (bcount > 0) ? bcount : 0;
+ bits_stream_len = 0;
+ bits_stream_raw = 0;
+ bits_stream_skipnext = false;
+ bits_stream_pos = 0;
+
  bits_buffer = 0;
  bits_buffered_bits = 0;
+ bits_needed_max = 0;
+ bits_raw_consumed = 0;
+
+ KING_RB_Peek(bits_raw, 0, bits_stream_total * 2 + 64);
+
+ if(!bits_stream_total)
+  memset(bits_stream, 0, 16);
 }
 
-static INLINE uint8 FetchWidgywabbit(void)
+static void DestuffBits(uint32 target)
 {
- if(bits_bytes_left <= 0)
-  return(0);
+ if(target > bits_stream_total)
+  target = bits_stream_total;
 
- uint8 ret = KING_RB_Fetch();
- if(ret == 0xFF) 
-  KING_RB_Fetch();
+ while(bits_stream_len < target)
+ {
+  const uint8 *raw = &bits_raw[bits_stream_raw];
+  const unsigned int raw_len = 64;
+  unsigned int i = 0;
 
- bits_bytes_left--;
+#if defined(__SSE2__)
+  if(!bits_stream_skipnext)
+  {
+   const __m128i ff = _mm_set1_epi8(0xFF);
 
- return(ret);
+   for(; i < raw_len && (bits_stream_len + 16) <= bits_stream_total; i += 16)
+   {
+    const __m128i v = _mm_loadu_si128((const __m128i *)&raw[i]);
+
+    if(_mm_movemask_epi8(_mm_cmpeq_epi8(v, ff)))
+     break;
+
+    _mm_storeu_si128((__m128i *)&bits_stream[bits_stream_len], v);
+    bits_stream_len += 16;
+   }
+  }
+#endif
+
+  for(; i < raw_len && bits_stream_len < bits_stream_total; i++)
+  {
+   if(bits_stream_skipnext)
+   {
+    bits_stream_skipnext = false;
+    continue;
+   }
+
+   bits_stream[bits_stream_len++] = raw[i];
+   bits_stream_skipnext = (raw[i] == 0xFF);
+  }
+
+  bits_stream_raw += i;
+ }
+
+ if(bits_stream_len == bits_stream_total)
+  memset(&bits_stream[bits_stream_len], 0, 16);
+}
+
+static void SyncBits(void)
+{
+ uint32 fetched = (bits_needed_max + 7) >> 3;
+ uint32 raw;
+
+ if(fetched > bits_stream_total)
+  fetched = bits_stream_total;
+
+ DestuffBits(fetched);
+
+ raw = fetched;
+ for(uint32 i = 0; i < fetched; i++)
+  raw += (bits_stream[i] == 0xFF);
+
+ bits_raw_consumed = raw;
+}
+
+static INLINE void RefillBits(void)
+{
+ const unsigned int nbytes = (63 - bits_buffered_bits) >> 3;
+ uint64 v = 0;
+
+ if((bits_stream_pos + 8) > bits_stream_len)
+  DestuffBits(bits_stream_pos + 8);
+
+ if(bits_stream_pos < bits_stream_len)
+  v = MDFN_de64msb(&bits_stream[bits_stream_pos]);
+
+ bits_buffer = (bits_buffer << (nbytes * 8)) | (v >> (64 - nbytes * 8));
+ bits_buffered_bits += nbytes * 8;
+ bits_stream_pos += nbytes;
 }
 
 enum
@@ -330,13 +505,13 @@ enum
 static INLINE uint32 GetBits(const unsigned int count, const unsigned int how = 0)
 {
  uint32 ret;
+ const uint32 needed = bits_stream_pos * 8 - bits_buffered_bits + count;
 
- while(bits_buffered_bits < count)
- {
-  bits_buffer <<= 8;
-  bits_buffer |= FetchWidgywabbit();
-  bits_buffered_bits += 8;
- }
+ if(needed > bits_needed_max)
+  bits_needed_max = needed;
+
+ if(bits_buffered_bits < count)
+  RefillBits();
 
  ret = (bits_buffer >> (bits_buffered_bits - count)) & ((1 << count) - 1);
 
@@ -377,6 +552,16 @@ static uint32 get_ac_coeff(const HuffmanQuickLUT *table, int32 *zeroes)
  uint32 code;
 
  rawbits = GetBits(12, MDFNBITS_PEEK);
+
+ if(table->fast[rawbits])
+ {
+  const uint32 sym = table->fast[rawbits];
+
+  SkipBits(sym & 0x1F);
+  *zeroes = (sym >> 8) & 0xF;
+  return((int32)sym >> 16);
+ }
+
  if((rawbits & 0xF80) == 0xF80)
  //if(rawbits >= 0xF80)
  {
@@ -402,6 +587,15 @@ static uint32 get_dc_coeff(const HuffmanQuickLUT *table, int32 *zeroes, int maxb
  {
   uint32 rawbits = GetBits(maxbits, MDFNBITS_PEEK);
 
+  if(table->fast[rawbits])
+  {
+   const uint32 sym = table->fast[rawbits];
+
+   SkipBits(sym & 0x1F);
+   *zeroes = 0;
+   return((int32)sym >> 16);
+  }
+
   code = table->lut[rawbits];
   SkipBits(table->lut_bits[rawbits]);
 
@@ -462,6 +656,14 @@ static uint32 get_dc_uv_coeff(void)
  uint32 code;
  uint32 rawbits = GetBits(8, MDFNBITS_PEEK);
 
+ if(table->fast[rawbits])
+ {
+  const uint32 sym = table->fast[rawbits];
+
+  SkipBits(sym & 0x1F);
+  return((int32)sym >> 16);
+ }
+
  code = table->lut[rawbits];
  SkipBits(table->lut_bits[rawbits]);
 
@@ -469,12 +671,14 @@ static uint32 get_dc_uv_coeff(void)
 }
 
 
-static void decode(int32 *dct, const uint32 *QuantTable, const int32 dc, const HuffmanQuickLUT *table)
+// Returns false if all the AC coefficients are zero, so the IDCT can take the DC-only shortcut.
+static bool decode(int32 *dct, const uint32 *QuantTable, const int32 dc, const HuffmanQuickLUT *table)
 {
  int32 coeff;
  int32 zeroes;
  int count;
  int index;
+ int32 ac_any = 0;
 
  dct[0] = (int16)(QuantTable[0] * dc);
  count = 0;
@@ -505,19 +709,654 @@ static void decode(int32 *dct, const uint32 *QuantTable, const int32 dc, const H
   {
    index = zigzag[count++];
    dct[index] = (int16)(QuantTable[index] * coeff);
+   ac_any |= dct[index];
   }
  } while(count < 63);
 
+ return(ac_any != 0);
 }
 
 static uint32 LastLine[256];
 static bool FirstDecode;
 static bool GarbageData;
 
-bool RAINBOW_Init(bool arg_ChromaIP)
+static int DecodeJobWhich;		// Buffer being decoded into
+static bool DecodeJobSkip;
+static uint32 DecodeJobHappyColor;
+
+//
+// Packs a decoded 16x16 macroblock(four 8x8 Y blocks, one 8x8 U and one 8x8 V) into 0x00YYUUVV pixels.  Without
+// ChromaIP, each chroma sample covers a 2x2 pixel square; with it, each sample goes to the bottom-left pixel of its square
+// only, and InterpolateChroma() fills in the rest once the whole block is done.
+//
+#if defined(__SSE2__)
+// Clamps (8 coefficients + 0x80) to 0...255, in 16-bit lanes.
+static INLINE __m128i SampleToU8(const int32 *coeffs)
+{
+ const __m128i s = _mm_packs_epi32(_mm_loadu_si128((const __m128i *)coeffs), _mm_loadu_si128((const __m128i *)(coeffs + 4)));
+ const __m128i t = _mm_adds_epi16(s, _mm_set1_epi16(0x80));
+
+ return(_mm_min_epi16(_mm_max_epi16(t, _mm_setzero_si128()), _mm_set1_epi16(0xFF)));
+}
+
+static void PackYUV(uint32 *dest, const int32 *dct_y, const int32 *dct_u, const int32 *dct_v)
+{
+ const __m128i zero = _mm_setzero_si128();
+
+ for(int cy = 0; cy < 8; cy++)
+ {
+  const __m128i uv = _mm_or_si128(_mm_slli_epi16(SampleToU8(&dct_u[cy * 8]), 8), SampleToU8(&dct_v[cy * 8]));
+  const __m128i uv_lo = _mm_unpacklo_epi16(uv, zero);	// Samples 0-3
+  const __m128i uv_hi = _mm_unpackhi_epi16(uv, zero);	// Samples 4-7
+  __m128i c[2][4];	// [row within pair][group of 4 pixels]
+
+  if(!ChromaIP)
+  {
+   c[0][0] = c[1][0] = _mm_unpacklo_epi32(uv_lo, uv_lo);
+   c[0][1] = c[1][1] = _mm_unpackhi_epi32(uv_lo, uv_lo);
+   c[0][2] = c[1][2] = _mm_unpacklo_epi32(uv_hi, uv_hi);
+   c[0][3] = c[1][3] = _mm_unpackhi_epi32(uv_hi, uv_hi);
+  }
+  else
+  {
+   c[0][0] = c[0][1] = c[0][2] = c[0][3] = zero;
+   c[1][0] = _mm_unpacklo_epi32(uv_lo, zero);
+   c[1][1] = _mm_unpackhi_epi32(uv_lo, zero);
+   c[1][2] = _mm_unpacklo_epi32(uv_hi, zero);
+   c[1][3] = _mm_unpackhi_epi32(uv_hi, zero);
+  }
+
+  for(int r = 0; r < 2; r++)
+  {
+   const int y = cy * 2 + r;
+   const __m128i y_l = SampleToU8(&dct_y[y * 8]);		// Pixels 0-7(blocks A/B)
+   const __m128i y_r = SampleToU8(&dct_y[0x80 + y * 8]);	// Pixels 8-15(blocks C/D)
+   uint32 *row = &dest[y * 256];
+
+   _mm_storeu_si128((__m128i *)&row[0x0], _mm_or_si128(_mm_unpacklo_epi16(zero, y_l), c[r][0]));
+   _mm_storeu_si128((__m128i *)&row[0x4], _mm_or_si128(_mm_unpackhi_epi16(zero, y_l), c[r][1]));
+   _mm_storeu_si128((__m128i *)&row[0x8], _mm_or_si128(_mm_unpacklo_epi16(zero, y_r), c[r][2]));
+   _mm_storeu_si128((__m128i *)&row[0xC], _mm_or_si128(_mm_unpackhi_epi16(zero, y_r), c[r][3]));
+  }
+ }
+}
+#else
+static void PackYUV(uint32 *dest_base_column, const int32 *dct_y, const int32 *dct_u, const int32 *dct_v)
+{
+ for(int y = 0; y < 16; y++)
+  for(int x = 0; x < 16; x++)
+   dest_base_column[y * 256 + x] = clamp_to_u8(dct_y[y * 8 + (x & 0x7) + ((x & 0x8) << 4)] + 0x80) << 16;
+
+ if(!ChromaIP)
+ {
+  for(int y = 0; y < 8; y++)
+  {
+   for(int x = 0; x < 8; x++)
+   {
+    uint32 component_uv = (clamp_to_u8(dct_u[y * 8 + x] + 0x80) << 8) | clamp_to_u8(dct_v[y * 8 + x] + 0x80);
+    dest_base_column[y * 512 + (256 * 0) + x * 2 + 0] |= component_uv;
+    dest_base_column[y * 512 + (256 * 0) + x * 2 + 1] |= component_uv;
+    dest_base_column[y * 512 + (256 * 1) + x * 2 + 0] |= component_uv;
+    dest_base_column[y * 512 + (256 * 1) + x * 2 + 1] |= component_uv;
+   }
+  }
+ }
+ else
+ {
+  for(int y = 0; y < 8; y++)
+  {
+   for(int x = 0; x < 8; x++)
+   {
+    uint32 component_uv = (clamp_to_u8(dct_u[y * 8 + x] + 0x80) << 8) | clamp_to_u8(dct_v[y * 8 + x] + 0x80);
+    dest_base_column[y * 512 + (256 * 1) + x * 2 + 0] |= component_uv;
+   }
+  }
+ }
+}
+#endif
+
+// Bilinear interpolation of the chroma samples PackYUV() left on the odd lines; the even lines are interpolated from
+// the odd lines above and below them, with the last line of the previous block(LastLine) above line 0.
+static void InterpolateChroma(uint32 *dest_base)
+{
+ for(int y = 0; y < 16; y+= 2)
+ {
+  uint32 *linebase = &dest_base[y * 256];
+  uint32 *linebase1 = &dest_base[(y + 1) * 256];
+  const uint32 *above = FirstDecode ? linebase1 : LastLine;	// Averaging a line with itself just copies it.
+  int x = 0;
+
+  //
+  // Horizontal, on the odd line: each odd pixel gets the average of the even pixels on either side of it.  U and V are
+  // averaged bytewise as (a & b) + (((a ^ b) & 0xFE) >> 1), which is floor((a + b) / 2) without carries between bytes.
+  //
+#if defined(__SSE2__)
+  {
+   const __m128i lsb_mask = _mm_set1_epi32(0xFEFEFEFE);
+   const __m128i sel = _mm_set_epi32(0xFFFF, 0, 0xFFFF, 0);	// UV of the odd pixels
+
+   for(; x < 252; x += 4)
+   {
+    const __m128i a = _mm_loadu_si128((const __m128i *)&linebase1[x]);
+    const __m128i b = _mm_loadu_si128((const __m128i *)&linebase1[x + 2]);
+    const __m128i avg = _mm_add_epi8(_mm_and_si128(a, b), _mm_srli_epi32(_mm_and_si128(_mm_xor_si128(a, b), lsb_mask), 1));
+
+    // Lane n of avg is the average of pixels x + n and x + n + 2, which is what pixel x + n + 1 wants.
+    _mm_storeu_si128((__m128i *)&linebase1[x], _mm_or_si128(_mm_andnot_si128(sel, a), _mm_and_si128(sel, _mm_slli_si128(avg, 4))));
+   }
+  }
+#endif
+
+  for(; x < 254; x += 2)
+  {
+   unsigned int u, v;
+
+   u = (((linebase1[x] >> 8) & 0xFF) + ((linebase1[x + 2] >> 8) & 0xFF)) >> 1;
+   v = (((linebase1[x] >> 0) & 0xFF) + ((linebase1[x + 2] >> 0) & 0xFF)) >> 1;
+
+   linebase1[x + 1] = (linebase1[x + 1] & ~ 0xFFFF) | (u << 8) | v;
+  }
+
+  linebase1[0xFF] = (linebase1[0xFF] & ~ 0xFFFF) | (linebase1[0xFE] & 0xFFFF);
+
+  // Vertical, on the even line; LastLine is updated as we go.
+  x = 0;
+
+#if defined(__SSE2__)
+  {
+   const __m128i lsb_mask = _mm_set1_epi32(0xFEFEFEFE);
+   const __m128i uv_mask = _mm_set1_epi32(0xFFFF);
+
+   for(; x < 256; x += 4)
+   {
+    const __m128i a = _mm_loadu_si128((const __m128i *)&above[x]);
+    const __m128i b = _mm_loadu_si128((const __m128i *)&linebase1[x]);
+    const __m128i l = _mm_loadu_si128((const __m128i *)&linebase[x]);
+    const __m128i avg = _mm_add_epi8(_mm_and_si128(a, b), _mm_srli_epi32(_mm_and_si128(_mm_xor_si128(a, b), lsb_mask), 1));
+
+    _mm_storeu_si128((__m128i *)&linebase[x], _mm_or_si128(_mm_andnot_si128(uv_mask, l), _mm_and_si128(uv_mask, avg)));
+    _mm_storeu_si128((__m128i *)&LastLine[x], b);
+   }
+  }
+#endif
+
+  for(; x < 256; x++)
+  {
+   unsigned int u, v;
+
+   u = (((above[x] >> 8) & 0xFF) + ((linebase1[x] >> 8) & 0xFF)) >> 1;
+   v = (((above[x] >> 0) & 0xFF) + ((linebase1[x] >> 0) & 0xFF)) >> 1;
+
+   linebase[x] = (linebase[x] & ~ 0xFFFF) | (u << 8) | v;
+   LastLine[x] = linebase1[x];
+  }
+
+  FirstDecode = false;
+ }
+}
+
+//
+// Decoded-strip cache.  Looping FMV(title screens, attract mode) feeds the same compressed blocks through again, so a block
+// whose data, quantizer tables and null run color match a cached one gets its pixels, final quantizer tables and KRAM usage
+// from the cache instead of being decoded.  Pixels are cached before chroma interpolation, which also depends on the
+// previous block(LastLine); ChromaIP itself is fixed for the cache's lifetime.
+//
+// When a long run of lookups goes without a hit, the cache stands down(no hashing of whole blocks, no copying of pixels)
+// and only remembers a cheap hash of the start of each block, until one of those comes around again.
+//
+typedef struct
+{
+ uint64 hash;
+ uint32 last_used;		// 0 = empty
+ uint32 data_len;
+ uint8 *data;			// Destuffed block data
+ uint32 quant[2][64];		// QuantTables, QuantTablesBase and HappyColor going in
+ uint32 quant_base[2][64];
+ uint32 happy_color;
+ uint32 quant_out[2][64];	// QuantTables coming out
+ uint32 raw_consumed;
+ uint32 pixels[256 * 16];
+} StripCacheEntry;
+
+enum { STRIP_CACHE_WINDOW = 1024 };	// Lookups without a hit before standing down
+
+static StripCacheEntry *StripCache = NULL;
+static uint32 StripCacheSize;
+static uint32 StripCacheTime;
+static uint32 StripCacheLookups, StripCacheHits;
+static bool StripCacheBypass;
+static uint64 *StripCacheProbes = NULL;	// Quick hashes seen while standing down, StripCacheSize entries
+static uint32 StripCacheProbePos;
+
+static uint64 HashBytes(const uint8 *data, uint32 len, uint64 h)
+{
+ const uint64 mul = 0x9E3779B97F4A7C15ULL;
+
+ for(; len >= 8; data += 8, len -= 8)
+ {
+  h = (h ^ MDFN_de64lsb(data)) * mul;
+  h ^= h >> 29;
+ }
+
+ for(; len; data++, len--)
+ {
+  h = (h ^ *data) * mul;
+  h ^= h >> 29;
+ }
+
+ return(h);
+}
+
+static void StripCacheKill(void)
+{
+ if(StripCache)
+ {
+  for(uint32 i = 0; i < StripCacheSize; i++)
+  {
+   if(StripCache[i].data)
+    free(StripCache[i].data);
+  }
+  free(StripCache);
+  StripCache = NULL;
+ }
+
+ if(StripCacheProbes)
+ {
+  free(StripCacheProbes);
+  StripCacheProbes = NULL;
+ }
+
+ StripCacheSize = 0;
+}
+
+static void StripCacheInit(uint32 megabytes)
+{
+ StripCacheSize = (uint64)megabytes * 1024 * 1024 / sizeof(StripCacheEntry);
+ StripCacheTime = 0;
+ StripCacheLookups = StripCacheHits = 0;
+ StripCacheBypass = false;
+ StripCacheProbePos = 0;
+
+ if(!StripCacheSize)
+  return;
+
+ if(!(StripCache = (StripCacheEntry *)calloc(StripCacheSize, sizeof(StripCacheEntry))) || !(StripCacheProbes = (uint64 *)calloc(StripCacheSize, sizeof(uint64))))
+  StripCacheKill();
+}
+
+//
+// Called before decoding a block.  Returns true if the block was found, in which case the job is done apart from chroma
+// interpolation; otherwise, *fill is set to the entry StripCacheStore() should put the decoded block in(or NULL).
+//
+static bool StripCacheFetch(uint32 *dest_base, StripCacheEntry **fill)
+{
+ const uint32 quick_len = (bits_stream_total < 64) ? bits_stream_total : 64;
+ StripCacheEntry *victim = &StripCache[0];
+ uint64 quick, hash;
+
+ *fill = NULL;
+
+ DestuffBits(quick_len);
+ quick = HashBytes(bits_stream, quick_len, bits_stream_total);
+
+ if(StripCacheBypass)
+ {
+  for(uint32 i = 0; i < StripCacheSize; i++)
+  {
+   if(StripCacheProbes[i] == quick)
+   {
+    StripCacheBypass = false;
+    break;
+   }
+  }
+
+  if(StripCacheBypass)
+  {
+   StripCacheProbes[StripCacheProbePos] = quick;
+   StripCacheProbePos = (StripCacheProbePos + 1) % StripCacheSize;
+   return(false);
+  }
+ }
+
+ DestuffBits(bits_stream_total);
+ hash = HashBytes(bits_stream, bits_stream_total, quick);
+ hash = HashBytes((const uint8 *)QuantTables, sizeof(QuantTables), hash);
+ hash = HashBytes((const uint8 *)QuantTablesBase, sizeof(QuantTablesBase), hash);
+ hash ^= DecodeJobHappyColor;
+
+ StripCacheTime++;
+ StripCacheLookups++;
+
+ for(uint32 i = 0; i < StripCacheSize; i++)
+ {
+  StripCacheEntry *ce = &StripCache[i];
+
+  if(ce->last_used && ce->hash == hash && ce->data_len == bits_stream_total && ce->happy_color == DecodeJobHappyColor &&
+	!memcmp(ce->data, bits_stream, bits_stream_total) && !memcmp(ce->quant, QuantTables, sizeof(QuantTables)) &&
+	!memcmp(ce->quant_base, QuantTablesBase, sizeof(QuantTablesBase)))
+  {
+   if(!DecodeJobSkip)
+   {
+    for(int y = 0; y < 16; y++)
+     memcpy(&dest_base[y * 256], &ce->pixels[y * 256], 256 * sizeof(uint32));
+   }
+
+   memcpy(QuantTables, ce->quant_out, sizeof(QuantTables));
+   bits_raw_consumed = ce->raw_consumed;
+   ce->last_used = StripCacheTime;
+   StripCacheHits++;
+   return(true);
+  }
+
+  if(ce->last_used < victim->last_used)
+   victim = ce;
+ }
+
+ if(StripCacheLookups >= STRIP_CACHE_WINDOW)
+ {
+  if(!StripCacheHits)
+  {
+   StripCacheBypass = true;
+   StripCacheProbePos = 0;
+   memset(StripCacheProbes, 0, StripCacheSize * sizeof(uint64));
+  }
+  StripCacheLookups = StripCacheHits = 0;
+ }
+
+ // Skipped decodes don't produce pixels to cache.
+ if(DecodeJobSkip)
+  return(false);
+
+ if(victim->data_len < bits_stream_total || !victim->data)
+ {
+  uint8 *data = (uint8 *)realloc(victim->data, bits_stream_total ? bits_stream_total : 1);
+
+  if(!data)
+   return(false);
+
+  victim->data = data;
+ }
+
+ victim->last_used = 0;
+ victim->hash = hash;
+ victim->data_len = bits_stream_total;
+ memcpy(victim->data, bits_stream, bits_stream_total);
+ memcpy(victim->quant, QuantTables, sizeof(QuantTables));
+ memcpy(victim->quant_base, QuantTablesBase, sizeof(QuantTablesBase));
+ victim->happy_color = DecodeJobHappyColor;
+
+ *fill = victim;
+
+ return(false);
+}
+
+static void StripCacheStore(StripCacheEntry *ce, const uint32 *dest_base)
+{
+ for(int y = 0; y < 16; y++)
+  memcpy(&ce->pixels[y * 256], &dest_base[y * 256], 256 * sizeof(uint32));
+
+ memcpy(ce->quant_out, QuantTables, sizeof(QuantTables));
+ ce->raw_consumed = bits_raw_consumed;
+ ce->last_used = StripCacheTime;
+}
+
+//
+// Entropy decoding, IDCT and chroma upsampling of a YUV block, from the data InitBits() grabbed.  Runs on the decode thread
+// when asynchronous decoding is enabled, so it must not touch KING or anything the main thread may change in the meantime.
+//
+static void DecodeYUV(void)
+{
+ int32 dc_y = 0, dc_u = 0, dc_v = 0;
+ uint32 *dest_base = (uint32 *)DecodeBuffer[DecodeJobWhich];
+ StripCacheEntry *fill = NULL;
+
+ if(StripCache && StripCacheFetch(dest_base, &fill))
+ {
+  if(!DecodeJobSkip && ChromaIP)
+   InterpolateChroma(dest_base);
+  return;
+ }
+
+ for(int column = 0; column < 16; column++)
+ {
+  uint32 *dest_base_column = &dest_base[column * 16];
+  int32 zeroes = 0;
+
+  dc_y += get_dc_y_coeff(&zeroes);
+
+  if(zeroes) // If set, clear the number of columns
+  {
+   do
+   {
+    if(column < 16)
+    {
+     dest_base_column = &dest_base[column * 16];
+
+     for(int y = 0; y < 16; y++)
+      for(int x = 0; x < 16; x++)
+       dest_base_column[y * 256 + x] = DecodeJobHappyColor;
+    }
+    column++;
+    zeroes--;
+   } while(zeroes);
+   column--; // Fix for the column autoincrement in the while(zeroes) loop
+   dc_y = dc_u = dc_v = 0;
+  }
+  else
+  {
+   int32 dct_y[256];
+   int32 dct_u[64];
+   int32 dct_v[64];
+   bool has_ac[6];
+
+   // Y/Luma, 16x16 components
+   // ---------
+   // | A | C |
+   // |-------|
+   // | B | D |
+   // ---------
+   // A (0, 0)
+   has_ac[0] = decode(&dct_y[0x00], QuantTables[0], dc_y, &ac_y_qlut);
+
+   // B (0, 1)
+   dc_y += get_dc_y_coeff(&zeroes);
+   has_ac[1] = decode(&dct_y[0x40], QuantTables[0], dc_y, &ac_y_qlut);
+
+   // C (1, 0)
+   dc_y += get_dc_y_coeff(&zeroes);
+   has_ac[2] = decode(&dct_y[0x80], QuantTables[0], dc_y, &ac_y_qlut);
+
+   // D (1, 1)
+   dc_y += get_dc_y_coeff(&zeroes);
+   has_ac[3] = decode(&dct_y[0xC0], QuantTables[0], dc_y, &ac_y_qlut);
+
+   // U, 8x8 components
+   dc_u += get_dc_uv_coeff();
+   has_ac[4] = decode(&dct_u[0x00], QuantTables[1], dc_u, &ac_uv_qlut);
+
+   // V, 8x8 components
+   dc_v += get_dc_uv_coeff();
+   has_ac[5] = decode(&dct_v[0x00], QuantTables[1], dc_v, &ac_uv_qlut);
+
+   if(DecodeJobSkip)
+    continue;
+
+   {
+    int32 *blocks[6] = { &dct_y[0x00], &dct_y[0x40], &dct_y[0x80], &dct_y[0xC0], &dct_u[0x00], &dct_v[0x00] };
+
+    for(int b = 0; b < 6; b++)
+    {
+     if(has_ac[b])
+      j_rev_dct(blocks[b]);
+     else
+      j_rev_dct_dc(blocks[b]);
+    }
+   }
+
+   PackYUV(dest_base_column, dct_y, dct_u, dct_v);
+  }
+ }
+
+ SyncBits();
+
+ if(fill)
+  StripCacheStore(fill, dest_base);
+
+ // Do bilinear interpolation on the chroma channels:
+ if(!DecodeJobSkip && ChromaIP)
+  InterpolateChroma(dest_base);
+}
+
+//
+// Asynchronous decoding: RAINBOW_DecodeBlock() reads the block header and grabs the block data on the emulation thread,
+// and hands the rest to the decode thread.  The block isn't needed until the buffer is swapped in 16 scanlines later, so
+// the emulation thread only waits on it when it gets there(or needs the decoder's state for some other reason), in
+// RAINBOW_WaitDecode().
+//
+static bool AsyncDecode;
+static bool DecodePending;	// Only touched by the emulation thread.
+
+#ifdef HAVE_THREADS
+static sthread_t *DecodeThread;
+static slock_t *DecodeMutex;
+static scond_t *DecodeCond;
+static scond_t *DecodeDoneCond;
+static bool DecodeBusy;
+static bool DecodeExit;
+
+static void DecodeThreadStart(void *arg)
+{
+ slock_lock(DecodeMutex);
+
+ for(;;)
+ {
+  while(!DecodeBusy && !DecodeExit)
+   scond_wait(DecodeCond, DecodeMutex);
+
+  if(DecodeExit)
+   break;
+
+  slock_unlock(DecodeMutex);
+
+  DecodeYUV();
+
+  slock_lock(DecodeMutex);
+  DecodeBusy = false;
+  scond_signal(DecodeDoneCond);
+ }
+
+ slock_unlock(DecodeMutex);
+}
+#endif
+
+static void DecodeKill(void)
+{
+#ifdef HAVE_THREADS
+ if(DecodeThread)
+ {
+  slock_lock(DecodeMutex);
+  DecodeExit = true;
+  scond_signal(DecodeCond);
+  slock_unlock(DecodeMutex);
+
+  sthread_join(DecodeThread);
+  DecodeThread = NULL;
+ }
+
+ if(DecodeMutex)
+ {
+  slock_free(DecodeMutex);
+  DecodeMutex = NULL;
+ }
+
+ if(DecodeCond)
+ {
+  scond_free(DecodeCond);
+  DecodeCond = NULL;
+ }
+
+ if(DecodeDoneCond)
+ {
+  scond_free(DecodeDoneCond);
+  DecodeDoneCond = NULL;
+ }
+#endif
+
+ AsyncDecode = false;
+ DecodePending = false;
+}
+
+static void DecodeInit(bool enable)
+{
+ AsyncDecode = false;
+ DecodePending = false;
+
+#ifdef HAVE_THREADS
+ if(!enable)
+  return;
+
+ DecodeMutex = slock_new();
+ DecodeCond = scond_new();
+ DecodeDoneCond = scond_new();
+ DecodeBusy = false;
+ DecodeExit = false;
+
+ if(!(DecodeThread = sthread_create(DecodeThreadStart, NULL)))
+ {
+  DecodeKill();
+  return;
+ }
+
+ AsyncDecode = true;
+#endif
+}
+
+static void SubmitDecode(void)
+{
+ DecodePending = true;
+
+#ifdef HAVE_THREADS
+ if(AsyncDecode)
+ {
+  slock_lock(DecodeMutex);
+  DecodeBusy = true;
+  scond_signal(DecodeCond);
+  slock_unlock(DecodeMutex);
+  return;
+ }
+#endif
+
+ DecodeYUV();
+ RAINBOW_WaitDecode();
+}
+
+void RAINBOW_WaitDecode(void)
+{
+ if(!DecodePending)
+  return;
+
+#ifdef HAVE_THREADS
+ if(AsyncDecode)
+ {
+  slock_lock(DecodeMutex);
+
+  while(DecodeBusy)
+   scond_wait(DecodeDoneCond, DecodeMutex);
+
+  slock_unlock(DecodeMutex);
+ }
+#endif
+
+ DecodePending = false;
+ KING_RB_Skip(bits_raw_consumed);
+}
+
+bool RAINBOW_Init(bool arg_ChromaIP, bool arg_AsyncDecode, uint32 arg_CacheSize)
 {
  ChromaIP = arg_ChromaIP;
 
+ j_rev_dct_init();
+
  for(int i = 0; i < 2; i++)
  {
   if(!(DecodeBuffer[i] = (uint8*)malloc(0x2000 * 4)))
@@ -525,29 +1364,37 @@ bool RAINBOW_Init(bool arg_ChromaIP)
   memset(DecodeBuffer[i], 0, 0x2000 * 4);
  }
 
- if(!BuildHuffmanLUT(&dc_y_table, &dc_y_qlut, 9))
+ if(!BuildHuffmanLUT(&dc_y_table, &dc_y_qlut, 9, false))
   return(FALSE);
 
- if(!BuildHuffmanLUT(&dc_uv_table, &dc_uv_qlut, 8))
+ if(!BuildHuffmanLUT(&dc_uv_table, &dc_uv_qlut, 8, false))
   return(FALSE);
 
- if(!BuildHuffmanLUT(&ac_y_table, &ac_y_qlut, 12))
+ if(!BuildHuffmanLUT(&ac_y_table, &ac_y_qlut, 12, true))
   return(FALSE);
 
- if(!BuildHuffmanLUT(&ac_uv_table, &ac_uv_qlut, 12))
+ if(!BuildHuffmanLUT(&ac_uv_table, &ac_uv_qlut, 12, true))
   return(FALSE);
 
  DecodeFormat[0] = DecodeFormat[1] = -1;
+ LineClears[0] = LineClears[1] = 0;
  DecodeBufferWhichRead = 0;
  GarbageData = FALSE;
  FirstDecode = TRUE;
  RasterReadPos = 0;
 
+ StripCacheInit(arg_CacheSize);
+ DecodeInit(arg_AsyncDecode);
+
  return(1);
 }
 
 void RAINBOW_Close(void)
 {
+ RAINBOW_WaitDecode();
+ DecodeKill();
+ StripCacheKill();
+
  for(int i = 0; i < 2; i++)
   if(DecodeBuffer[i])
   {
@@ -598,6 +1445,8 @@ void RAINBOW_Write16(uint32 A, uint16 V)
 
 void RAINBOW_ForceTransferReset(void)
 {
+ RAINBOW_WaitDecode();
+
  RasterReadPos = 0;
  DecodeFormat[0] = DecodeFormat[1] = -1;
 }
@@ -615,6 +1464,8 @@ void RAINBOW_DecodeBlock(bool arg_FirstDecode, bool Skip)
    int icount;
    int which_buffer = DecodeBufferWhichRead ^ 1;
 
+   RAINBOW_WaitDecode();
+
    if(!(Control & 0x01))
     return;
 
@@ -658,6 +1509,7 @@ void RAINBOW_DecodeBlock(bool arg_FirstDecode, bool Skip)
    {
     GarbageData = TRUE;
     DecodeFormat[which_buffer] = 0;
+    FlushLineClears(which_buffer);
     memset(DecodeBuffer[which_buffer], 0, 0x2000);
     goto BufferNoDecode;
    }
@@ -684,149 +1536,16 @@ void RAINBOW_DecodeBlock(bool arg_FirstDecode, bool Skip)
 
     InitBits(block_size);
 
-    int32 dc_y = 0, dc_u = 0, dc_v = 0;
-    uint32 *dest_base = (uint32 *)DecodeBuffer[which_buffer];
-    for(int column = 0; column < 16; column++)
-    {
-     uint32 *dest_base_column = &dest_base[column * 16];
-     int32 zeroes = 0;
-
-     dc_y += get_dc_y_coeff(&zeroes);
-
-     if(zeroes) // If set, clear the number of columns
-     {
-      do
-      {
-       if(column < 16)
-       {
-	dest_base_column = &dest_base[column * 16];
-
-        for(int y = 0; y < 16; y++)
-         for(int x = 0; x < 16; x++)
-          dest_base_column[y * 256 + x] = HappyColor;
-       }
-       column++;
-       zeroes--;
-      } while(zeroes);
-      column--; // Fix for the column autoincrement in the while(zeroes) loop
-      dc_y = dc_u = dc_v = 0;
-     }
-     else
-     {
-      int32 dct_y[256];
-      int32 dct_u[64];
-      int32 dct_v[64];
-
-      // Y/Luma, 16x16 components
-      // ---------
-      // | A | C |
-      // |-------|
-      // | B | D |
-      // ---------
-      // A (0, 0)
-      decode(&dct_y[0x00], QuantTables[0], dc_y, &ac_y_qlut);
-
-      // B (0, 1)
-      dc_y += get_dc_y_coeff(&zeroes);
-      decode(&dct_y[0x40], QuantTables[0], dc_y, &ac_y_qlut);
-
-      // C (1, 0)
-      dc_y += get_dc_y_coeff(&zeroes);
-      decode(&dct_y[0x80], QuantTables[0], dc_y, &ac_y_qlut);
-
-      // D (1, 1)
-      dc_y += get_dc_y_coeff(&zeroes);
-      decode(&dct_y[0xC0], QuantTables[0], dc_y, &ac_y_qlut);
-
-      // U, 8x8 components
-      dc_u += get_dc_uv_coeff();
-      decode(&dct_u[0x00], QuantTables[1], dc_u, &ac_uv_qlut);
-
-      // V, 8x8 components
-      dc_v += get_dc_uv_coeff();
-      decode(&dct_v[0x00], QuantTables[1], dc_v, &ac_uv_qlut);
-
-      if(Skip)
-       continue;
-
-      j_rev_dct(&dct_y[0x00]);
-      j_rev_dct(&dct_y[0x40]);
-      j_rev_dct(&dct_y[0x80]);
-      j_rev_dct(&dct_y[0xC0]);
-      j_rev_dct(&dct_u[0x00]);
-      j_rev_dct(&dct_v[0x00]);
-
-      for(int y = 0; y < 16; y++)
-       for(int x = 0; x < 16; x++)
-        dest_base_column[y * 256 + x] = clamp_to_u8(dct_y[y * 8 + (x & 0x7) + ((x & 0x8) << 4)] + 0x80) << 16;
-
-      if(!ChromaIP)
-      {
-       for(int y = 0; y < 8; y++)
-       {
-        for(int x = 0; x < 8; x++)
-        {
-         uint32 component_uv = (clamp_to_u8(dct_u[y * 8 + x] + 0x80) << 8) | clamp_to_u8(dct_v[y * 8 + x] + 0x80);
-         dest_base_column[y * 512 + (256 * 0) + x * 2 + 0] |= component_uv;
-         dest_base_column[y * 512 + (256 * 0) + x * 2 + 1] |= component_uv;
-         dest_base_column[y * 512 + (256 * 1) + x * 2 + 0] |= component_uv;
-         dest_base_column[y * 512 + (256 * 1) + x * 2 + 1] |= component_uv;
-        }
-       }
-      }
-      else
-      {
-       for(int y = 0; y < 8; y++)
-       {
-        for(int x = 0; x < 8; x++)
-        {
-         uint32 component_uv = (clamp_to_u8(dct_u[y * 8 + x] + 0x80) << 8) | clamp_to_u8(dct_v[y * 8 + x] + 0x80);
- 	 dest_base_column[y * 512 + (256 * 1) + x * 2 + 0] |= component_uv;
-        }
-       }
-      }
-     }
-    }
-
-    // Do bilinear interpolation on the chroma channels:
-    if(!Skip && ChromaIP)
-    {
-     for(int y = 0; y < 16; y+= 2)
-     {
-      uint32 *linebase = &dest_base[y * 256];
-      uint32 *linebase1 = &dest_base[(y + 1) * 256];
-
-      for(int x = 0; x < 254; x += 2)
-      {
-       unsigned int u, v;
-
-       u = (((linebase1[x] >> 8) & 0xFF) + ((linebase1[x + 2] >> 8) & 0xFF)) >> 1;
-       v = (((linebase1[x] >> 0) & 0xFF) + ((linebase1[x + 2] >> 0) & 0xFF)) >> 1;
-
-       linebase1[x + 1] = (linebase1[x + 1] & ~ 0xFFFF) | (u << 8) | v;
-      }
-
-      linebase1[0xFF] = (linebase1[0xFF] & ~ 0xFFFF) | (linebase1[0xFE] & 0xFFFF);
+    // Unless skipping, every pixel of the block is written.
+    if(Skip)
+     FlushLineClears(which_buffer);
+    else
+     LineClears[which_buffer] = 0;
 
-      if(FirstDecode)
-      {
-       for(int x = 0; x < 256; x++) linebase[x] = (linebase[x] & ~ 0xFFFF) | (linebase1[x] & 0xFFFF);
-       FirstDecode = 0;
-      }
-      else
-       for(int x = 0; x < 256; x++)
-       {
-        unsigned int u, v;
- 
-        u = (((LastLine[x] >> 8) & 0xFF) + ((linebase1[x] >> 8) & 0xFF)) >> 1;
-        v = (((LastLine[x] >> 0) & 0xFF) + ((linebase1[x] >> 0) & 0xFF)) >> 1;
-
-        linebase[x] = (linebase[x] & ~ 0xFFFF) | (u << 8) | v;
-       }
-
-      memcpy(LastLine, linebase1, 256 * 4);
-     }
-    } // End chroma interpolation
+    DecodeJobWhich = which_buffer;
+    DecodeJobSkip = Skip;
+    DecodeJobHappyColor = HappyColor;
+    SubmitDecode();
    } // end jpeg-like decoding
    else 
    {
@@ -835,6 +1554,8 @@ void RAINBOW_DecodeBlock(bool arg_FirstDecode, bool Skip)
     const unsigned int plt_shift = 4 - (block_type & 0x3);
     const unsigned int crl_mask = (1 << plt_shift) - 1;
     int x = 0;
+
+    FlushLineClears(which_buffer);
     
     while(block_size > 0)
     {
@@ -882,11 +1603,43 @@ void RAINBOW_DecodeBlock(bool arg_FirstDecode, bool Skip)
 
 void KING_Moo(void);
 
+//
+// Horizontal scrolling splits each output line into at most two runs of consecutive source pixels(plus a run of
+// transparent pixels in non-endless mode), handled by these.
+//
+static INLINE void YUVSpan(uint32 *dest, const uint32 *src, const unsigned int count, const uint32 layer_or)
+{
+ unsigned int x = 0;
+
+#if defined(__SSE2__)
+ const __m128i lo = _mm_set1_epi32(layer_or);
+
+ for(; x + 4 <= count; x += 4)
+  _mm_storeu_si128((__m128i *)&dest[x], _mm_or_si128(_mm_loadu_si128((const __m128i *)&src[x]), lo));
+#endif
+
+ for(; x < count; x++)
+  dest[x] = src[x] | layer_or;
+}
+
+static INLINE void PaletteSpan(uint32 *dest, const uint8 *src, const unsigned int count, const uint32 layer_or, const uint32 *palette_ptr)
+{
+ for(unsigned int x = 0; x < count; x++)
+ {
+  const uint8 index = src[x];
+
+  dest[x] = index ? (palette_ptr[index] | layer_or) : 0;
+ }
+}
+
 // NOTE:  layer_or and palette_ptr are optimizations, the real RAINBOW chip knows not of such things.
 int RAINBOW_FetchRaster(uint32 *linebuffer, uint32 layer_or, uint32 *palette_ptr)
 {
  int ret;
 
+ if(DecodePending && DecodeJobWhich == (int)DecodeBufferWhichRead)
+  RAINBOW_WaitDecode();
+
  ret = DecodeFormat[DecodeBufferWhichRead];
 
  if(linebuffer)
@@ -898,55 +1651,61 @@ int RAINBOW_FetchRaster(uint32 *linebuffer, uint32 layer_or, uint32 *palette_ptr
   }
   else if(DecodeFormat[DecodeBufferWhichRead] == 1)	// YUV
   {
-   uint32 *in_ptr = (uint32*)&DecodeBuffer[DecodeBufferWhichRead][RasterReadPos * 256 * 4];
+   const uint32 *in_ptr = (uint32*)&DecodeBuffer[DecodeBufferWhichRead][RasterReadPos * 256 * 4];
+
+   if(LineClears[DecodeBufferWhichRead] & (1 << RasterReadPos))
+    in_ptr = ZeroLine;
 
    if(Control & 0x2)	// Endless scroll mode:
    {
-    uint8 tmpss = HScroll;
+    const unsigned int hs = HScroll & 0xFF;
 
-    for(int x = 0; x < 256; x++)
-    {
-     linebuffer[x] = in_ptr[tmpss] | layer_or;
-     tmpss++;
-    }
+    YUVSpan(linebuffer, in_ptr + hs, 256 - hs, layer_or);
+    YUVSpan(linebuffer + 256 - hs, in_ptr, hs, layer_or);
    }
    else // Non-endless
    {
-    uint16 tmpss = HScroll & 0x1FF;
+    const unsigned int hs = HScroll & 0x1FF;
 
-    for(int x = 0; x < 256; x++)
+    if(hs < 256)
     {
-     linebuffer[x] = (tmpss < 256) ? (in_ptr[tmpss] | layer_or) : 0;
-     tmpss = (tmpss + 1) & 0x1FF;
+     YUVSpan(linebuffer, in_ptr + hs, 256 - hs, layer_or);
+     memset(linebuffer + 256 - hs, 0, hs * sizeof(uint32));
+    }
+    else
+    {
+     memset(linebuffer, 0, (512 - hs) * sizeof(uint32));
+     YUVSpan(linebuffer + 512 - hs, in_ptr, hs - 256, layer_or);
     }
    }
-    MDFN_FastU32MemsetM8(in_ptr, 0, 256);
+   LineClears[DecodeBufferWhichRead] |= 1 << RasterReadPos;
   }
   else if(DecodeFormat[DecodeBufferWhichRead] == 0)	// Palette
   {
-   uint8 *in_ptr = &DecodeBuffer[DecodeBufferWhichRead][RasterReadPos * 256];
+   const uint8 *in_ptr = &DecodeBuffer[DecodeBufferWhichRead][RasterReadPos * 256];
 
    if(Control & 0x2)    // Endless scroll mode:
    {
-    uint8 tmpss = HScroll;
+    const unsigned int hs = HScroll & 0xFF;
 
-    for(int x = 0; x < 256; x++)
-    {
-     linebuffer[x] = in_ptr[tmpss] ? (palette_ptr[in_ptr[tmpss]] | layer_or) : 0;
-     tmpss++;
-    }
+    PaletteSpan(linebuffer, in_ptr + hs, 256 - hs, layer_or, palette_ptr);
+    PaletteSpan(linebuffer + 256 - hs, in_ptr, hs, layer_or, palette_ptr);
    }
    else // Non-endless
    {
-    uint16 tmpss = HScroll & 0x1FF;
+    const unsigned int hs = HScroll & 0x1FF;
 
-    for(int x = 0; x < 256; x++)
+    if(hs < 256)
     {
-     linebuffer[x] = (tmpss < 256 && in_ptr[tmpss]) ? (palette_ptr[in_ptr[tmpss]] | layer_or) : 0;
-     tmpss = (tmpss + 1) & 0x1FF;
+     PaletteSpan(linebuffer, in_ptr + hs, 256 - hs, layer_or, palette_ptr);
+     memset(linebuffer + 256 - hs, 0, hs * sizeof(uint32));
+    }
+    else
+    {
+     memset(linebuffer, 0, (512 - hs) * sizeof(uint32));
+     PaletteSpan(linebuffer + 512 - hs, in_ptr, hs - 256, layer_or, palette_ptr);
     }
    }
-   //MDFN_FastU32MemsetM8((uint32 *)in_ptr, 0, 256 / 4);
   }
  }
 
@@ -960,6 +1719,8 @@ int RAINBOW_FetchRaster(uint32 *linebuffer, uint32 layer_or, uint32 *palette_ptr
 
 void RAINBOW_Reset(void)
 {
+ RAINBOW_WaitDecode();
+
  Control = 0;
  NullRunY = NullRunU = NullRunV = 0;
  HScroll = 0;
@@ -976,6 +1737,12 @@ void RAINBOW_Reset(void)
 
 int RAINBOW_StateAction(StateMem *sm, int load, int data_only)
 {
+ RAINBOW_WaitDecode();
+
+ // Save states hold the buffers with the read-out lines cleared.
+ FlushLineClears(0);
+ FlushLineClears(1);
+
  SFORMAT StateRegs[] =
  {
    SFVAR(HScroll),
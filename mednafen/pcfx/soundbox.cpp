@@ -113,7 +113,7 @@ bool SoundBox_SetSoundRate(uint32 rate)
    return(TRUE);
 }
 
-int SoundBox_Init(bool arg_EmulateBuggyCodec, bool arg_ResetAntiClickEnabled)
+int SoundBox_Init(bool arg_EmulateBuggyCodec, bool arg_ResetAntiClickEnabled, bool arg_PSGBatch)
 {
    adpcm_lastts = 0;
    SoundEnabled = false;
@@ -128,6 +128,7 @@ int SoundBox_Init(bool arg_EmulateBuggyCodec, bool arg_ResetAntiClickEnabled)
    }
 
    pce_psg = new PCE_PSG(FXsbuf[0]->Buf(), FXsbuf[1]->Buf(), PCE_PSG::REVISION_HUC6280A);
+   pce_psg->SetBatchDeltas(arg_PSGBatch);
 
    memset(&sbox, 0, sizeof(sbox));
 
@@ -275,146 +276,255 @@ static const int16 ADPCM_PhaseFilter[8][7] =
  /*   7 */ {     1,    56,   331,   683,   654,   283,    40 }, //  2048
 };
 
-v810_timestamp_t SoundBox_ADPCMUpdate(const v810_timestamp_t timestamp)
+//
+// ADPCM playback is run in batches: the emulation only has to stop for it(via the ADPCM event) on the samples where a
+// channel fetches a new halfword from KRAM, which can raise KING's ADPCM IRQ; everything in between only affects the
+// sound output, and is produced on the way to the next fetch.  Anything else that affects playback(SoundBox register
+// writes, KING ADPCM control writes) catches up with SoundBox_ADPCMUpdate() first.
+//
+enum
 {
-   int32 run_time = timestamp - adpcm_lastts;
+ ADPCM_BATCH_SAMPLES = 64,					// Samples decoded per pass, and most samples between events
+ ADPCM_BATCH_FETCHES = (ADPCM_BATCH_SAMPLES + 1 + 3) / 4 + 1	// Most halfword fetches per channel per pass
+};
 
-   adpcm_lastts = timestamp;
+// Nibble clock ticks over the next "count" samples.
+static uint32 CountNibbleTicks(int32 smalldiv, const int32 period, uint32 count)
+{
+   uint32 ticks = 0;
 
-   sbox.bigdiv -= run_time * 2;
+   while(count--)
+   {
+      smalldiv--;
+      while(smalldiv <= 0)
+      {
+         smalldiv += period;
+         ticks++;
+      }
+   }
+
+   return(ticks);
+}
 
-   while(sbox.bigdiv <= 0)
+// Samples until the next one where a channel fetches a halfword, up to ADPCM_BATCH_SAMPLES.
+static uint32 SamplesUntilFetch(void)
+{
+   const int32 period = 1 << ((KINGADPCMControl >> 2) & 0x3);
+   int32 smalldiv = sbox.smalldiv;
+   uint32 nibble[2] = { sbox.ADPCMWhichNibble[0], sbox.ADPCMWhichNibble[1] };
+   bool have_halfword[2] = { sbox.ADPCMHaveHalfWord[0], sbox.ADPCMHaveHalfWord[1] };
+
+   for(uint32 i = 0; i < ADPCM_BATCH_SAMPLES; i++)
    {
-      sbox.smalldiv--;
-      while(sbox.smalldiv <= 0)
+      smalldiv--;
+      while(smalldiv <= 0)
       {
-         sbox.smalldiv += 1 << ((KINGADPCMControl >> 2) & 0x3);
+         smalldiv += period;
          for(int ch = 0; ch < 2; ch++)
          {
-            // Keep playing our last halfword fetched even if KING ADPCM is disabled
-            if(sbox.ADPCMHaveHalfWord[ch] || KINGADPCMControl & (1 << ch)) 
+            if(have_halfword[ch] || KINGADPCMControl & (1 << ch))
             {
-               if(!sbox.ADPCMWhichNibble[ch])
-               {
-                  sbox.ADPCMHalfWord[ch] = KING_GetADPCMHalfWord(ch);
-                  sbox.ADPCMHaveHalfWord[ch] = TRUE;
-               }
+               if(!nibble[ch])
+                  return(i);
 
-               // If the channel's reset bit is set, don't update its ADPCM state.
-               if(sbox.ADPCMControl & (0x10 << ch))
-               {
-                  sbox.ADPCMDelta[ch] = 0;
-               }
-               else
-               {
-                  uint8 nibble = (sbox.ADPCMHalfWord[ch] >> (sbox.ADPCMWhichNibble[ch])) & 0xF;
-                  int32 BaseStepSize = StepSizes[sbox.StepSizeIndex[ch]];
+               nibble[ch] = (nibble[ch] + 4) & 0xF;
+
+               if(!nibble[ch])
+                  have_halfword[ch] = false;
+            }
+         }
+      }
+   }
 
-                  if(EmulateBuggyCodec)
+   return(ADPCM_BATCH_SAMPLES);
+}
+
+static void RunADPCM(const v810_timestamp_t timestamp, uint32 count)
+{
+   while(count)
+   {
+      const uint32 batch = std::min<uint32>(count, ADPCM_BATCH_SAMPLES);
+      const unsigned rate_shift = (KINGADPCMControl >> 2) & 0x3;
+      const int32 period = 1 << rate_shift;
+      const uint32 ticks = CountNibbleTicks(sbox.smalldiv, period, batch);
+      uint16 halfwords[2][ADPCM_BATCH_FETCHES];
+      uint32 hw_count[2], hw_pos[2] = { 0, 0 };
+      bool enabled[2], ends_disabled[2];
+
+      //
+      // Fetch all the halfwords the batch will need up front.  A channel fetches on every 4th tick(when its nibble position
+      // wraps to 0), if KING ADPCM is enabled for it(or, after a state load, it still has a halfword); the fetch of the
+      // last halfword of a non-looping buffer disables the channel, which stops the fetches that follow it.
+      //
+      for(int ch = 0; ch < 2; ch++)
+      {
+         const uint32 nibble = sbox.ADPCMWhichNibble[ch];
+         uint32 fetches = 0;
+
+         enabled[ch] = (KINGADPCMControl >> ch) & 1;
+
+         if(!(nibble & 0x3))
+         {
+            const uint32 first = ((16 - nibble) & 0xF) >> 2;
+
+            if(first < ticks)
+               fetches = (ticks - first + 3) >> 2;
+         }
+
+         if(!enabled[ch] && !(sbox.ADPCMHaveHalfWord[ch] && !nibble))
+            fetches = 0;
+
+         hw_count[ch] = fetches ? KING_GetADPCMHalfWords(ch, halfwords[ch], fetches) : 0;
+         ends_disabled[ch] = enabled[ch] && !((KINGADPCMControl >> ch) & 1);
+      }
+
+      for(uint32 i = 0; i < batch; i++)
+      {
+         sbox.smalldiv--;
+         while(sbox.smalldiv <= 0)
+         {
+            sbox.smalldiv += period;
+            for(int ch = 0; ch < 2; ch++)
+            {
+               // KING ADPCM is still enabled for the channel unless we're past the fetch that disabled it.
+               const bool ch_enabled = enabled[ch] && !(ends_disabled[ch] && hw_pos[ch] == hw_count[ch]);
+
+               // Keep playing our last halfword fetched even if KING ADPCM is disabled
+               if(sbox.ADPCMHaveHalfWord[ch] || ch_enabled)
+               {
+                  if(!sbox.ADPCMWhichNibble[ch])
                   {
-                     if(BaseStepSize == 1552)
-                        BaseStepSize = 1522;
+                     sbox.ADPCMHalfWord[ch] = halfwords[ch][hw_pos[ch]++];
+                     sbox.ADPCMHaveHalfWord[ch] = TRUE;
+                  }
 
-                     sbox.ADPCMDelta[ch] = BaseStepSize * ((nibble & 0x7) + 1) * 2;
+                  // If the channel's reset bit is set, don't update its ADPCM state.
+                  if(sbox.ADPCMControl & (0x10 << ch))
+                  {
+                     sbox.ADPCMDelta[ch] = 0;
                   }
                   else
-                     sbox.ADPCMDelta[ch] = BaseStepSize * ((nibble & 0x7) + 1);
+                  {
+                     uint8 nibble = (sbox.ADPCMHalfWord[ch] >> (sbox.ADPCMWhichNibble[ch])) & 0xF;
+                     int32 BaseStepSize = StepSizes[sbox.StepSizeIndex[ch]];
 
-                  // Linear interpolation turned on?
-                  if(sbox.ADPCMControl & (0x4 << ch))
-                     sbox.ADPCMDelta[ch] >>= (KINGADPCMControl >> 2) & 0x3;
+                     if(EmulateBuggyCodec)
+                     {
+                        if(BaseStepSize == 1552)
+                           BaseStepSize = 1522;
 
-                  if(nibble & 0x8)
-                     sbox.ADPCMDelta[ch] = -sbox.ADPCMDelta[ch];
+                        sbox.ADPCMDelta[ch] = BaseStepSize * ((nibble & 0x7) + 1) * 2;
+                     }
+                     else
+                        sbox.ADPCMDelta[ch] = BaseStepSize * ((nibble & 0x7) + 1);
 
-                  sbox.StepSizeIndex[ch] += StepIndexDeltas[nibble];
+                     // Linear interpolation turned on?
+                     if(sbox.ADPCMControl & (0x4 << ch))
+                        sbox.ADPCMDelta[ch] >>= rate_shift;
 
-                  if(sbox.StepSizeIndex[ch] < 0)
-                     sbox.StepSizeIndex[ch] = 0;
+                     if(nibble & 0x8)
+                        sbox.ADPCMDelta[ch] = -sbox.ADPCMDelta[ch];
 
-                  if(sbox.StepSizeIndex[ch] > 48)
-                     sbox.StepSizeIndex[ch] = 48;
-               }
-               sbox.ADPCMHaveDelta[ch] = 1;
+                     sbox.StepSizeIndex[ch] += StepIndexDeltas[nibble];
 
-               // Linear interpolation turned on?
-               if(sbox.ADPCMControl & (0x4 << ch))
-                  sbox.ADPCMHaveDelta[ch] = 1 << ((KINGADPCMControl >> 2) & 0x3);
+                     if(sbox.StepSizeIndex[ch] < 0)
+                        sbox.StepSizeIndex[ch] = 0;
 
-               sbox.ADPCMWhichNibble[ch] = (sbox.ADPCMWhichNibble[ch] + 4) & 0xF;
+                     if(sbox.StepSizeIndex[ch] > 48)
+                        sbox.StepSizeIndex[ch] = 48;
+                  }
+                  sbox.ADPCMHaveDelta[ch] = 1;
 
-               if(!sbox.ADPCMWhichNibble[ch])
-                  sbox.ADPCMHaveHalfWord[ch] = FALSE;
-            }
-         } // for(int ch...)
-      } // while(sbox.smalldiv <= 0)
+                  // Linear interpolation turned on?
+                  if(sbox.ADPCMControl & (0x4 << ch))
+                     sbox.ADPCMHaveDelta[ch] = period;
 
-      const uint32 synthtime42 = (timestamp << 1) + sbox.bigdiv;
-      const uint32 synthtime14 = synthtime42 / 3;
-      const uint32 synthtime = synthtime14 >> 3;
-      const unsigned synthtime_phase = synthtime14 & 7;
+                  sbox.ADPCMWhichNibble[ch] = (sbox.ADPCMWhichNibble[ch] + 4) & 0xF;
 
-      for(int ch = 0; ch < 2; ch++)
-      {
-         if(sbox.ADPCMHaveDelta[ch]) 
-         {
-            sbox.ADPCMPredictor[ch] += sbox.ADPCMDelta[ch];
+                  if(!sbox.ADPCMWhichNibble[ch])
+                     sbox.ADPCMHaveHalfWord[ch] = FALSE;
+               }
+            } // for(int ch...)
+         } // while(sbox.smalldiv <= 0)
 
-            sbox.ADPCMHaveDelta[ch]--;
+         const uint32 synthtime42 = (timestamp << 1) + sbox.bigdiv;
+         const uint32 synthtime14 = synthtime42 / 3;
+         const uint32 synthtime = synthtime14 >> 3;
+         const unsigned synthtime_phase = synthtime14 & 7;
 
-            if(sbox.ADPCMPredictor[ch] > 0x3FFF) { sbox.ADPCMPredictor[ch] = 0x3FFF; }
-            if(sbox.ADPCMPredictor[ch] < -0x4000) { sbox.ADPCMPredictor[ch] = -0x4000;  }
-         }
-         else
+         for(int ch = 0; ch < 2; ch++)
          {
+            if(sbox.ADPCMHaveDelta[ch]) 
+            {
+               sbox.ADPCMPredictor[ch] += sbox.ADPCMDelta[ch];
 
-         }
-
-         if(SoundEnabled)
-         {
-            int32 samp[2];
+               sbox.ADPCMHaveDelta[ch]--;
 
-            if(EmulateBuggyCodec)
-            {
-               samp[0] = (int32)(((sbox.ADPCMPredictor[ch] >> 1) + (sbox.ResetAntiClick[ch] >> 33)) * sbox.VolumeFiltered[ch][0]);
-               samp[1] = (int32)(((sbox.ADPCMPredictor[ch] >> 1) + (sbox.ResetAntiClick[ch] >> 33)) * sbox.VolumeFiltered[ch][1]);
+               if(sbox.ADPCMPredictor[ch] > 0x3FFF) { sbox.ADPCMPredictor[ch] = 0x3FFF; }
+               if(sbox.ADPCMPredictor[ch] < -0x4000) { sbox.ADPCMPredictor[ch] = -0x4000;  }
             }
-            else
-            {
-               samp[0] = (int32)((sbox.ADPCMPredictor[ch] + (sbox.ResetAntiClick[ch] >> 32)) * sbox.VolumeFiltered[ch][0]);
-               samp[1] = (int32)((sbox.ADPCMPredictor[ch] + (sbox.ResetAntiClick[ch] >> 32)) * sbox.VolumeFiltered[ch][1]);
-            }
-            for(unsigned y = 0; y < 2; y++)
+
+            if(SoundEnabled)
             {
-               const int32 delta = samp[y] - sbox.ADPCM_last[ch][y];
-               int32* tb = FXsbuf[y]->Buf() + (synthtime & 0xFFFF);
-               const int16* coeffs = ADPCM_PhaseFilter[synthtime_phase];
+               int32 samp[2];
 
-               for(unsigned c = 0; c < 7; c++)
+               if(EmulateBuggyCodec)
+               {
+                  samp[0] = (int32)(((sbox.ADPCMPredictor[ch] >> 1) + (sbox.ResetAntiClick[ch] >> 33)) * sbox.VolumeFiltered[ch][0]);
+                  samp[1] = (int32)(((sbox.ADPCMPredictor[ch] >> 1) + (sbox.ResetAntiClick[ch] >> 33)) * sbox.VolumeFiltered[ch][1]);
+               }
+               else
+               {
+                  samp[0] = (int32)((sbox.ADPCMPredictor[ch] + (sbox.ResetAntiClick[ch] >> 32)) * sbox.VolumeFiltered[ch][0]);
+                  samp[1] = (int32)((sbox.ADPCMPredictor[ch] + (sbox.ResetAntiClick[ch] >> 32)) * sbox.VolumeFiltered[ch][1]);
+               }
+               for(unsigned y = 0; y < 2; y++)
                {
-                  int32 tmp = delta * coeffs[c];
+                  const int32 delta = samp[y] - sbox.ADPCM_last[ch][y];
+                  int32* tb = FXsbuf[y]->Buf() + (synthtime & 0xFFFF);
+                  const int16* coeffs = ADPCM_PhaseFilter[synthtime_phase];
 
-                  tb[c] += tmp;
+                  for(unsigned c = 0; c < 7; c++)
+                  {
+                     int32 tmp = delta * coeffs[c];
+
+                     tb[c] += tmp;
+                  }
                }
-            }
 
-            sbox.ADPCM_last[ch][0] = samp[0];
-            sbox.ADPCM_last[ch][1] = samp[1];
+               sbox.ADPCM_last[ch][0] = samp[0];
+               sbox.ADPCM_last[ch][1] = samp[1];
+            }
          }
-      }
 
-      for(int ch = 0; ch < 2; ch++)
-         sbox.ResetAntiClick[ch] -= sbox.ResetAntiClick[ch] >> 8;
+         for(int ch = 0; ch < 2; ch++)
+            sbox.ResetAntiClick[ch] -= sbox.ResetAntiClick[ch] >> 8;
 
-      for(int ch = 0; ch < 2; ch++)
-         for(int lr = 0; lr < 2; lr++)
-         {
-            DoVolumeFilter(ch, lr);
-         }
-      sbox.bigdiv += 1365 * 2 / 2;
+         for(int ch = 0; ch < 2; ch++)
+            for(int lr = 0; lr < 2; lr++)
+            {
+               DoVolumeFilter(ch, lr);
+            }
+         sbox.bigdiv += 1365 * 2 / 2;
+      }
+
+      count -= batch;
    }
+}
+
+v810_timestamp_t SoundBox_ADPCMUpdate(const v810_timestamp_t timestamp)
+{
+   int32 run_time = timestamp - adpcm_lastts;
+
+   adpcm_lastts = timestamp;
 
-   return(timestamp + (sbox.bigdiv + 1) / 2);
+   sbox.bigdiv -= run_time * 2;
+
+   // Run every sample due by now(bigdiv <= 0), then schedule the next event for the next sample with a fetch.
+   if(sbox.bigdiv <= 0)
+      RunADPCM(timestamp, (uint32)-sbox.bigdiv / 1365 + 1);
+
+   return(timestamp + (sbox.bigdiv + 1365 * SamplesUntilFetch() + 1) / 2);
 }
 
 int32 SoundBox_Flush(const v810_timestamp_t end_timestamp, v810_timestamp_t* new_base_timestamp, int16 *SoundBuf, const int32 MaxSoundFrames)
@@ -429,18 +539,21 @@ int32 SoundBox_Flush(const v810_timestamp_t end_timestamp, v810_timestamp_t* new
 
    pce_psg->Update(end_timestamp_div3);
 
-   for(unsigned y = 0; y < 2; y++)
+   if(SoundEnabled && FXres)
    {
-      if(SoundEnabled && FXres)
-      {
+      for(unsigned y = 0; y < 2; y++)
          FXsbuf[y]->Integrate(rsc, 0, 0, FXCDDABufs[y]);
-         FrameCount = FXres->Resample(FXsbuf[y], rsc, SoundBuf + y, MaxSoundFrames);
-      }
-      else
+
+      FrameCount = FXres->ResampleStereo(FXsbuf[0], FXsbuf[1], rsc, SoundBuf, MaxSoundFrames);
+   }
+   else
+   {
+      for(unsigned y = 0; y < 2; y++)
          FXsbuf[y]->ResampleSkipped(rsc);
+   }
 
+   for(unsigned y = 0; y < 2; y++)
       FXCDDABufs[y]->Finish(rsc);
-   }
 
    return(FrameCount);
 }
@@ -28,7 +28,14 @@ int setting_nospritelimit = 1;
 int setting_resamp_quality = 0;
 int setting_suppress_channel_reset_clicks = 1;
 int setting_emulate_buggy_codec = 0;
+int setting_psg_batch = 0;
 int setting_rainbow_chromaip = 0;
+int setting_rainbow_async = 0;
+int setting_rainbow_cache = 0;
+int setting_frame_pipelining = 0;
+int setting_chd_hunk_cache = 16;
+int setting_chd_prefetch = 4;
+int setting_cd_readahead = 64;
 
 uint64_t MDFN_GetSettingUI(const char *name)
 {
@@ -40,8 +47,16 @@ uint64_t MDFN_GetSettingUI(const char *name)
       return setting_initial_scanline;
    if (!strcmp("pcfx.high_dotclock_width", name))
       return setting_high_dotclock_width;
+   if (!strcmp("pcfx.rainbow.cache", name))
+      return setting_rainbow_cache;
    if (!strcmp("pcfx.resamp_quality", name))
       return setting_resamp_quality;
+   if (!strcmp("pcfx.chd.hunk_cache", name))
+      return setting_chd_hunk_cache;
+   if (!strcmp("pcfx.chd.prefetch", name))
+      return setting_chd_prefetch;
+   if (!strcmp("pcfx.cd_readahead", name))
+      return setting_cd_readahead;
    return 0;
 }
 
@@ -82,8 +97,14 @@ bool MDFN_GetSettingB(const char *name)
       return 0; /* TODO - make configurable */
    if (!strcmp("pcfx.adpcm.emulate_buggy_codec", name))
       return setting_emulate_buggy_codec;
+   if (!strcmp("pcfx.psg.batch", name))
+      return setting_psg_batch;
    if (!strcmp("pcfx.rainbow.chromaip", name))
       return setting_rainbow_chromaip;
+   if (!strcmp("pcfx.rainbow.async", name))
+      return setting_rainbow_async;
+   if (!strcmp("pcfx.frame_pipelining", name))
+      return setting_frame_pipelining;
    return 0;
 }
 
@@ -15,7 +15,14 @@ extern int setting_nospritelimit;
 extern int setting_resamp_quality;
 extern int setting_suppress_channel_reset_clicks;
 extern int setting_emulate_buggy_codec;
+extern int setting_psg_batch;
 extern int setting_rainbow_chromaip;
+extern int setting_rainbow_async;
+extern int setting_rainbow_cache;
+extern int setting_frame_pipelining;
+extern int setting_chd_hunk_cache;
+extern int setting_chd_prefetch;
+extern int setting_cd_readahead;
 
 // This should assert() or something if the setting isn't found, since it would
 // be a totally tubular error!
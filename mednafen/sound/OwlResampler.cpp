@@ -38,6 +38,15 @@ extern retro_get_cpu_features_t perf_get_cpu_features_cb;
  #include <altivec.h>
 #endif
 
+#if defined(__SSE2__)
+ #include <emmintrin.h>
+#endif
+
+#if defined(ARCH_X86) && defined(__GNUC__) && (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+ #include <immintrin.h>
+ #define OWLRESAMP_HAVE_AVX2
+#endif
+
 //#ifdef __FAST_MATH__
 // #error "OwlResampler.cpp not compatible with unsafe math optimizations!"
 //#endif
@@ -382,6 +391,32 @@ static INLINE void DoMAC_SSE(float *wave, float *coeffs, int32 count, int32 *acc
 #endif
 );
 }
+
+#ifdef OWLRESAMP_HAVE_AVX2
+//
+// Same lane layout and summation order as DoMAC_SSE(xmm4:xmm5 in acc0, xmm6:xmm7 in acc1), so the results are
+// bit-identical.  Separate multiplies and adds are kept on purpose; FMA would skip the intermediate rounding.
+//
+__attribute__((target("avx2"))) static void DoMAC_AVX2(float *wave, float *coeffs, int32 count, int32 *accum_output)
+{
+ __m256 acc0 = _mm256_setzero_ps();
+ __m256 acc1 = _mm256_setzero_ps();
+ __m128 sum;
+
+ for(int32 c = 0; c < count; c += 16)
+ {
+  acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(wave + c + 0), _mm256_load_ps(coeffs + c + 0)));
+  acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(wave + c + 8), _mm256_load_ps(coeffs + c + 8)));
+ }
+
+ sum = _mm_add_ps(_mm_add_ps(_mm256_castps256_ps128(acc1), _mm256_extractf128_ps(acc1, 1)),
+		  _mm_add_ps(_mm256_castps256_ps128(acc0), _mm256_extractf128_ps(acc0, 1)));
+ sum = _mm_add_ps(sum, _mm_shuffle_ps(sum, sum, 27));
+ sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+
+ *accum_output = _mm_cvtss_si32(sum);
+}
+#endif
 #elif defined(ARCH_POWERPC_ALTIVEC)
 static INLINE void DoMAC_AltiVec(float* wave, float* coeffs, int32 count, int32* accum_output)
 {
@@ -480,6 +515,98 @@ static INLINE void DoMAC_AltiVec(float* wave, float* coeffs, int32 count, int32*
 }
 #endif
 
+//
+// Stereo variants of the above: one pass over the coefficients for both channels, with each channel summed
+// in the same order as its mono kernel(so the output is identical to resampling the channels separately).
+//
+static INLINE void DoMAC_Stereo(float *wave_l, float *wave_r, float *coeffs, int32 count, int32 *accum_output)
+{
+ float acc_l[4] = { 0, 0, 0, 0 };
+ float acc_r[4] = { 0, 0, 0, 0 };
+
+ for(int c = 0; c < count; c += 4)
+ {
+  for(int i = 0; i < 4; i++)
+  {
+   acc_l[i] += wave_l[c + i] * coeffs[c + i];
+   acc_r[i] += wave_r[c + i] * coeffs[c + i];
+  }
+ }
+
+ accum_output[0] = (acc_l[0] + acc_l[2]) + (acc_l[1] + acc_l[3]);
+ accum_output[1] = (acc_r[0] + acc_r[2]) + (acc_r[1] + acc_r[3]);
+}
+
+#if defined(ARCH_X86) && defined(__SSE2__)
+// Horizontal sum in the same order as the tail of DoMAC_SSE.
+static INLINE int32 HSum_SSE(__m128 acc0, __m128 acc1, __m128 acc2, __m128 acc3)
+{
+ __m128 sum = _mm_add_ps(_mm_add_ps(acc3, acc2), _mm_add_ps(acc1, acc0));
+
+ sum = _mm_add_ps(sum, _mm_shuffle_ps(sum, sum, 27));
+ sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+
+ return _mm_cvtss_si32(sum);
+}
+
+static INLINE void DoMAC_Stereo_SSE(float *wave_l, float *wave_r, float *coeffs, int32 count, int32 *accum_output)
+{
+ __m128 l0 = _mm_setzero_ps(), l1 = _mm_setzero_ps(), l2 = _mm_setzero_ps(), l3 = _mm_setzero_ps();
+ __m128 r0 = _mm_setzero_ps(), r1 = _mm_setzero_ps(), r2 = _mm_setzero_ps(), r3 = _mm_setzero_ps();
+
+ for(int32 c = 0; c < count; c += 16)
+ {
+  const __m128 c0 = _mm_load_ps(coeffs + c +  0);
+  const __m128 c1 = _mm_load_ps(coeffs + c +  4);
+  const __m128 c2 = _mm_load_ps(coeffs + c +  8);
+  const __m128 c3 = _mm_load_ps(coeffs + c + 12);
+
+  l0 = _mm_add_ps(l0, _mm_mul_ps(_mm_loadu_ps(wave_l + c +  0), c0));
+  l1 = _mm_add_ps(l1, _mm_mul_ps(_mm_loadu_ps(wave_l + c +  4), c1));
+  l2 = _mm_add_ps(l2, _mm_mul_ps(_mm_loadu_ps(wave_l + c +  8), c2));
+  l3 = _mm_add_ps(l3, _mm_mul_ps(_mm_loadu_ps(wave_l + c + 12), c3));
+
+  r0 = _mm_add_ps(r0, _mm_mul_ps(_mm_loadu_ps(wave_r + c +  0), c0));
+  r1 = _mm_add_ps(r1, _mm_mul_ps(_mm_loadu_ps(wave_r + c +  4), c1));
+  r2 = _mm_add_ps(r2, _mm_mul_ps(_mm_loadu_ps(wave_r + c +  8), c2));
+  r3 = _mm_add_ps(r3, _mm_mul_ps(_mm_loadu_ps(wave_r + c + 12), c3));
+ }
+
+ accum_output[0] = HSum_SSE(l0, l1, l2, l3);
+ accum_output[1] = HSum_SSE(r0, r1, r2, r3);
+}
+#endif
+
+#ifdef OWLRESAMP_HAVE_AVX2
+__attribute__((target("avx2"))) static void DoMAC_Stereo_AVX2(float *wave_l, float *wave_r, float *coeffs, int32 count, int32 *accum_output)
+{
+ __m256 l0 = _mm256_setzero_ps(), l1 = _mm256_setzero_ps();
+ __m256 r0 = _mm256_setzero_ps(), r1 = _mm256_setzero_ps();
+ __m128 sum;
+
+ for(int32 c = 0; c < count; c += 16)
+ {
+  const __m256 c0 = _mm256_load_ps(coeffs + c + 0);
+  const __m256 c1 = _mm256_load_ps(coeffs + c + 8);
+
+  l0 = _mm256_add_ps(l0, _mm256_mul_ps(_mm256_loadu_ps(wave_l + c + 0), c0));
+  l1 = _mm256_add_ps(l1, _mm256_mul_ps(_mm256_loadu_ps(wave_l + c + 8), c1));
+  r0 = _mm256_add_ps(r0, _mm256_mul_ps(_mm256_loadu_ps(wave_r + c + 0), c0));
+  r1 = _mm256_add_ps(r1, _mm256_mul_ps(_mm256_loadu_ps(wave_r + c + 8), c1));
+ }
+
+ sum = _mm_add_ps(_mm_add_ps(_mm256_castps256_ps128(l1), _mm256_extractf128_ps(l1, 1)),
+		  _mm_add_ps(_mm256_castps256_ps128(l0), _mm256_extractf128_ps(l0, 1)));
+ sum = _mm_add_ps(sum, _mm_shuffle_ps(sum, sum, 27));
+ accum_output[0] = _mm_cvtss_si32(_mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1)));
+
+ sum = _mm_add_ps(_mm_add_ps(_mm256_castps256_ps128(r1), _mm256_extractf128_ps(r1, 1)),
+		  _mm_add_ps(_mm256_castps256_ps128(r0), _mm256_extractf128_ps(r0, 1)));
+ sum = _mm_add_ps(sum, _mm_shuffle_ps(sum, sum, 27));
+ accum_output[1] = _mm_cvtss_si32(_mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1)));
+}
+#endif
+
 template<typename T, unsigned sa>
 static T SDP2(T v)
 {
@@ -490,6 +617,64 @@ static T SDP2(T v)
  return ((v + tmp) >> sa);
 }
 
+//
+// Runs the debias filter over count intermediate samples of buffer in, and writes them out(to every other int16).
+//
+void OwlResampler::Debias(OwlBuffer* in, const int32* src, int16* out, const uint32 count)
+{
+   int64 debias = in->debias;
+
+   for(uint32 x = 0; x < count; x++)
+   {
+      int32 sample = src[x];
+      int32 s;
+
+      debias += ((((int64)sample << 16) - debias) * debias_multiplier) >> 16;
+      s = SDP2<int32, 8>(sample - (debias >> 16));
+
+      if(s < -32768 || s > 32767)
+      {
+         if(s < -32768)
+            s = -32768;
+         else if(s > 32767)
+            s = 32767;
+      }
+      out[x * 2] = s;
+   }
+
+   in->debias = debias;
+}
+
+//
+// Saves the resampling position, and moves the unconsumed input down to the start of the buffer.
+//
+void OwlResampler::FinishBuf(OwlBuffer* in, const uint32 in_count, uint32 InputPhase, uint32 InputIndex)
+{
+   const uint32 in_count_WLO = in->leftover + in_count;
+   int32 leftover;
+
+   if(InputIndex > in_count_WLO)
+   {
+      leftover = 0;
+      InputIndex -= in_count_WLO;
+   }
+   else
+   {
+      leftover = (int32)in_count_WLO - (int32)InputIndex;
+      InputIndex = 0;
+   }
+
+   memmove(in->Buf() - leftover,
+         in->Buf() + in_count - leftover,
+         sizeof(int32) * (leftover + OwlBuffer::HRBUF_OVERFLOW_PADDING));
+
+   memset(in->Buf() + OwlBuffer::HRBUF_OVERFLOW_PADDING, 0, sizeof(int32) * in_count);
+
+   in->leftover = leftover;
+   in->InputPhase = InputPhase;
+   in->InputIndex = InputIndex;
+}
+
 int32 OwlResampler::Resample(OwlBuffer* in, const uint32 in_count, int16* out, const uint32 max_out_count)
 {
 	uint32 count = 0;
@@ -500,7 +685,6 @@ int32 OwlResampler::Resample(OwlBuffer* in, const uint32 in_count, int16* out, c
         uint32 InputPhase = in->InputPhase;
         uint32 InputIndex = in->InputIndex;
 	OwlBuffer::I32_F_Pudding* InSamps = in->BufPudding() - in->leftover;
-	int32 leftover;
 
    while(InputIndex < max)
    {
@@ -510,6 +694,14 @@ int32 OwlResampler::Resample(OwlBuffer* in, const uint32 in_count, int16* out, c
       int32 coeff_count = NumCoeffs;
 
 #ifdef ARCH_X86
+#ifdef OWLRESAMP_HAVE_AVX2
+      if(cpuext & RETRO_SIMD_AVX2)
+      {
+         DoMAC_AVX2(wave, coeffs, coeff_count, I32Out);
+         handled = true;
+      }
+      else
+#endif
       if(cpuext & RETRO_SIMD_SSE2)
       {
          DoMAC_SSE(wave, coeffs, coeff_count, I32Out);
@@ -532,52 +724,97 @@ int32 OwlResampler::Resample(OwlBuffer* in, const uint32 in_count, int16* out, c
       InputIndex += PhaseStep[InputPhase];
    }
 
-   if(InputIndex > in_count_WLO)
+   Debias(in, boobuf, out, count);
+   FinishBuf(in, in_count, InputPhase, InputIndex);
+
+	return(count);
+}
+
+int32 OwlResampler::ResampleStereo(OwlBuffer* in_l, OwlBuffer* in_r, const uint32 in_count, int16* out, const uint32 max_out_count)
+{
+   //
+   // Both buffers have to be at the same position in the input; they always are when they're only ever resampled
+   // together, but fall back to doing them one at a time if not.  Same when there's no stereo kernel as good as
+   // the mono one(AltiVec, and x86 builds without SSE2 intrinsics).
+   //
+   bool separate = (in_l->leftover != in_r->leftover || in_l->InputPhase != in_r->InputPhase || in_l->InputIndex != in_r->InputIndex);
+#if defined(ARCH_POWERPC_ALTIVEC) || (defined(ARCH_X86) && !defined(__SSE2__))
+   if(!(cpuext & RETRO_SIMD_AVX2))
+      separate = true;
+#endif
+
+   if(separate)
    {
-      leftover = 0;
-      InputIndex -= in_count_WLO;
+      Resample(in_l, in_count, out + 0, max_out_count);
+      return Resample(in_r, in_count, out + 1, max_out_count);
    }
-   else
+
+   uint32 count = 0;
+   int32 *boobuf = &IntermediateBuffer[0];
+   const uint32 in_count_WLO = in_l->leftover + in_count;
+   const uint32 max = std::max<int64>(0, (int64)in_count_WLO - NumCoeffs);
+   uint32 InputPhase = in_l->InputPhase;
+   uint32 InputIndex = in_l->InputIndex;
+   OwlBuffer::I32_F_Pudding* InSamps_L = in_l->BufPudding() - in_l->leftover;
+   OwlBuffer::I32_F_Pudding* InSamps_R = in_r->BufPudding() - in_r->leftover;
+
+   while(InputIndex < max)
    {
-      leftover = (int32)in_count_WLO - (int32)InputIndex;
-      InputIndex = 0;
+      float* wave_l     = &InSamps_L[InputIndex].f;
+      float* wave_r     = &InSamps_R[InputIndex].f;
+      float* coeffs     = &FIR_Coeffs[InputPhase][0].f;
+      int32 coeff_count = NumCoeffs;
+
+#ifdef OWLRESAMP_HAVE_AVX2
+      if(cpuext & RETRO_SIMD_AVX2)
+         DoMAC_Stereo_AVX2(wave_l, wave_r, coeffs, coeff_count, &boobuf[count * 2]);
+      else
+#endif
+#if defined(ARCH_X86) && defined(__SSE2__)
+      if(cpuext & RETRO_SIMD_SSE2)
+         DoMAC_Stereo_SSE(wave_l, wave_r, coeffs, coeff_count, &boobuf[count * 2]);
+      else
+#endif
+         DoMAC_Stereo(wave_l, wave_r, coeffs, coeff_count, &boobuf[count * 2]);
+
+      count++;
+
+      InputPhase = PhaseNext[InputPhase];
+      InputIndex += PhaseStep[InputPhase];
    }
 
+   //
+   // The intermediate samples are interleaved, so the debias filter can split them out straight into the
+   // interleaved output.
+   //
    {
-      int64 debias = in->debias;
+      int64 debias[2] = { in_l->debias, in_r->debias };
 
-      for(uint32 x = 0; x < count; x++)
+      for(uint32 x = 0; x < count * 2; x++)
       {
          int32 sample = boobuf[x];
+         int64* d = &debias[x & 1];
          int32 s;
 
-         debias += ((((int64)sample << 16) - debias) * debias_multiplier) >> 16;
-         s = SDP2<int32, 8>(sample - (debias >> 16));
-
-         if(s < -32768 || s > 32767)
-         {
-            if(s < -32768)
-               s = -32768;
-            else if(s > 32767)
-               s = 32767;
-         }
-         out[x * 2] = s;
-      }
+         *d += ((((int64)sample << 16) - *d) * debias_multiplier) >> 16;
+         s = SDP2<int32, 8>(sample - (*d >> 16));
 
-      in->debias = debias;
-   }
+         if(s < -32768)
+            s = -32768;
+         else if(s > 32767)
+            s = 32767;
 
-   memmove(in->Buf() - leftover,
-         in->Buf() + in_count - leftover,
-         sizeof(int32) * (leftover + OwlBuffer::HRBUF_OVERFLOW_PADDING));
+         out[x] = s;
+      }
 
-   memset(in->Buf() + OwlBuffer::HRBUF_OVERFLOW_PADDING, 0, sizeof(int32) * in_count);
+      in_l->debias = debias[0];
+      in_r->debias = debias[1];
+   }
 
-	in->leftover = leftover;
-	in->InputPhase = InputPhase;
-	in->InputIndex = InputIndex;
+   FinishBuf(in_l, in_count, InputPhase, InputIndex);
+   FinishBuf(in_r, in_count, InputPhase, InputIndex);
 
-	return(count);
+   return(count);
 }
 
 void OwlResampler::ResetBufResampState(OwlBuffer* buf)
@@ -587,28 +824,116 @@ void OwlResampler::ResetBufResampState(OwlBuffer* buf)
 }
 
 
-OwlResampler::~OwlResampler()
+//
+// Generated phase and coefficient tables, shared(read-only) between all resamplers created with the same parameters, and kept
+// around for a while after the last of them is destroyed, so that recreating the resampler for a sound rate or quality change
+// doesn't have to generate them all over again.
+//
+struct OwlFilterBank
+{
+ double InputRate, OutputRate, RateError;
+ int Quality;
+ uint32 CoeffAlign;
+
+ unsigned RefCount;
+ uint64 LastUsed;
+
+ uint32 NumPhases;
+ uint32 NumCoeffs;
+ uint32 NumCoeffs_Padded;
+ int32 Ratio_Dividend;
+ int32 Ratio_Divisor;
+
+ uint32 *PhaseNext;
+ uint32 *PhaseStep;
+ uint32 *PhaseStepSave;
+ OwlBuffer::I32_F_Pudding **FIR_Coeffs;
+ OwlBuffer::I32_F_Pudding **FIR_Coeffs_Real;
+};
+
+enum { FILTERBANK_MAX_UNUSED = 4 };	// Max number of banks kept with no resampler using them.
+
+static std::vector<OwlFilterBank*> FilterBanks;
+static uint64 FilterBankUseCounter = 0;
+
+static void FreeFilterBank(OwlFilterBank* fb)
 {
- if(PhaseNext)
-  free(PhaseNext);
+ if(fb->PhaseNext)
+  free(fb->PhaseNext);
 
- if(PhaseStep)
-  free(PhaseStep);
+ if(fb->PhaseStep)
+  free(fb->PhaseStep);
 
- if(PhaseStepSave)
-  free(PhaseStepSave);
+ if(fb->PhaseStepSave)
+  free(fb->PhaseStepSave);
 
- if(FIR_Coeffs_Real)
+ if(fb->FIR_Coeffs_Real)
  {
-  for(unsigned int i = 0; i < NumPhases; i++)
-   if(FIR_Coeffs_Real[i])
-    free(FIR_Coeffs_Real[i]);
+  for(unsigned int i = 0; i < fb->NumPhases; i++)
+   if(fb->FIR_Coeffs_Real[i])
+    free(fb->FIR_Coeffs_Real[i]);
 
-  free(FIR_Coeffs_Real);
+  free(fb->FIR_Coeffs_Real);
  }
 
- if(FIR_Coeffs)
-  free(FIR_Coeffs);
+ if(fb->FIR_Coeffs)
+  free(fb->FIR_Coeffs);
+
+ delete fb;
+}
+
+//
+// Frees the least-recently used unreferenced banks, down to FILTERBANK_MAX_UNUSED of them.
+//
+static void PruneFilterBanks(void)
+{
+ for(;;)
+ {
+  unsigned unused = 0;
+  int oldest = -1;
+
+  for(unsigned i = 0; i < FilterBanks.size(); i++)
+  {
+   if(FilterBanks[i]->RefCount)
+    continue;
+
+   unused++;
+   if(oldest < 0 || FilterBanks[i]->LastUsed < FilterBanks[oldest]->LastUsed)
+    oldest = i;
+  }
+
+  if(unused <= FILTERBANK_MAX_UNUSED)
+   break;
+
+  FreeFilterBank(FilterBanks[oldest]);
+  FilterBanks.erase(FilterBanks.begin() + oldest);
+ }
+}
+
+void OwlResampler::UseFilterBank(OwlFilterBank* fb)
+{
+ Bank = fb;
+ Bank->RefCount++;
+ Bank->LastUsed = ++FilterBankUseCounter;
+
+ NumPhases = fb->NumPhases;
+ NumCoeffs = fb->NumCoeffs;
+ NumCoeffs_Padded = fb->NumCoeffs_Padded;
+ Ratio_Dividend = fb->Ratio_Dividend;
+ Ratio_Divisor = fb->Ratio_Divisor;
+
+ PhaseNext = fb->PhaseNext;
+ PhaseStep = fb->PhaseStep;
+ PhaseStepSave = fb->PhaseStepSave;
+ FIR_Coeffs = fb->FIR_Coeffs;
+ FIR_Coeffs_Real = fb->FIR_Coeffs_Real;
+}
+
+OwlResampler::~OwlResampler()
+{
+ Bank->RefCount--;
+ Bank->LastUsed = ++FilterBankUseCounter;
+ PruneFilterBanks();
 }
 
 //
@@ -643,12 +968,50 @@ OwlResampler::OwlResampler(double input_rate, double output_rate, double rate_er
  DebiasCorner = debias_corner;
  Quality = quality;
 
- IntermediateBuffer.resize(OutputRate * 4 / 50);	// *4 for safety padding, / min(50,60), an approximate calculation
+ debias_multiplier = (uint32)(((uint64)1 << 16) * debias_corner / output_rate);
+
+ IntermediateBuffer.resize(OutputRate * 4 * 2 / 50);	// *4 for safety padding, *2 for ResampleStereo(), / min(50,60), an approximate calculation
 
  cpuext = 0;
  if (perf_get_cpu_features_cb)
     cpuext = perf_get_cpu_features_cb();
 
+ //
+ // The AVX2 kernel is only there when the compiler can build it, and is picked by asking the CPU directly, so
+ // one binary uses it wherever it's available(and doesn't depend on the frontend's features callback).
+ //
+ cpuext &= ~RETRO_SIMD_AVX2;
+#ifdef OWLRESAMP_HAVE_AVX2
+ __builtin_cpu_init();
+ if(__builtin_cpu_supports("sse2"))
+  cpuext |= RETRO_SIMD_SSE2;
+ if(__builtin_cpu_supports("avx2"))
+  cpuext |= RETRO_SIMD_AVX2;
+#endif
+
+ //
+ // The coefficient count is padded out to a multiple of what the MAC loop in use does per iteration.
+ //
+ uint32 CoeffAlign = 4;	// Default loop does 4 MACs per iteration.
+ #ifdef ARCH_X86
+ if(cpuext & (RETRO_SIMD_SSE2 | RETRO_SIMD_AVX2))
+  CoeffAlign = 16;	// SSE and AVX2 loops do 16 MACs per iteration.
+ #endif
+ #ifdef ARCH_POWERPC_ALTIVEC
+ CoeffAlign = 16;	// AltiVec loop does 16 MACs per iteration.
+ #endif
+
+ for(unsigned i = 0; i < FilterBanks.size(); i++)
+ {
+  OwlFilterBank* fb = FilterBanks[i];
+
+  if(fb->InputRate == input_rate && fb->OutputRate == output_rate && fb->RateError == rate_error && fb->Quality == quality && fb->CoeffAlign == CoeffAlign)
+  {
+   UseFilterBank(fb);
+   return;
+  }
+ }
+
  // Get the number of phases required, and adjust ratio.
  {
   double s_ratio = (double)input_rate / output_rate;
@@ -730,33 +1093,8 @@ OwlResampler::OwlResampler(double input_rate, double output_rate, double rate_er
  if(NumCoeffs < 16)
   NumCoeffs = 16;
 
- if(0)
- {
-  abort();	// The sky is falling AAAAAAAAAAAAA
- }
- #ifdef ARCH_X86
- else if(cpuext & RETRO_SIMD_SSE2)
- {
-
-  // SSE loop does 16 MACs per iteration.
-  NumCoeffs = (NumCoeffs + 15) &~ 15;
-  NumCoeffs_Padded = NumCoeffs;
- }
- #endif
- #ifdef ARCH_POWERPC_ALTIVEC
- else if(1)
- {
-  // AltiVec loop does 16 MACs per iteration.
-  NumCoeffs = (NumCoeffs + 15) &~ 15;
-  NumCoeffs_Padded = NumCoeffs;
- }
- #endif
- else
- {
-  // Default loop does 4 MACs per iteration.
-  NumCoeffs = (NumCoeffs + 3) &~ 3;
-  NumCoeffs_Padded = NumCoeffs;
- }
+ NumCoeffs = (NumCoeffs + CoeffAlign - 1) &~ (CoeffAlign - 1);
+ NumCoeffs_Padded = NumCoeffs;
 
  // Adjust cutoff now that NumCoeffs may have been increased.
  cutoff = std::min<double>(QualityTable[quality].obw * something / input_rate, (std::min<double>(input_rate, output_rate) / input_rate - ((double)k_d / NumCoeffs)));
@@ -766,11 +1104,12 @@ OwlResampler::OwlResampler(double input_rate, double output_rate, double rate_er
 
  for(unsigned int i = 0; i < NumPhases; i++)
  {
-  uint8 *tmp_ptr = (uint8 *)calloc(sizeof(int32) * NumCoeffs_Padded + 16, 1);
+  // 32-byte aligned, for the AVX2 kernel's aligned coefficient loads.
+  uint8 *tmp_ptr = (uint8 *)calloc(sizeof(int32) * NumCoeffs_Padded + 32, 1);
 
   FIR_Coeffs_Real[i] = (OwlBuffer::I32_F_Pudding *)tmp_ptr;
-  tmp_ptr += 0xF;
-  tmp_ptr -= ((unsigned long long)tmp_ptr & 0xF);
+  tmp_ptr += 0x1F;
+  tmp_ptr -= ((unsigned long long)tmp_ptr & 0x1F);
   FIR_Coeffs[i] = (OwlBuffer::I32_F_Pudding *)tmp_ptr;
  }
 
@@ -799,5 +1138,31 @@ OwlResampler::OwlResampler(double input_rate, double output_rate, double rate_er
  free(FilterBuf);
  FilterBuf = NULL;
 
- debias_multiplier = (uint32)(((uint64)1 << 16) * debias_corner / output_rate);
+ {
+  OwlFilterBank* fb = new OwlFilterBank;
+
+  fb->InputRate = input_rate;
+  fb->OutputRate = output_rate;
+  fb->RateError = rate_error;
+  fb->Quality = quality;
+  fb->CoeffAlign = CoeffAlign;
+
+  fb->RefCount = 0;
+  fb->LastUsed = 0;
+
+  fb->NumPhases = NumPhases;
+  fb->NumCoeffs = NumCoeffs;
+  fb->NumCoeffs_Padded = NumCoeffs_Padded;
+  fb->Ratio_Dividend = Ratio_Dividend;
+  fb->Ratio_Divisor = Ratio_Divisor;
+
+  fb->PhaseNext = PhaseNext;
+  fb->PhaseStep = PhaseStep;
+  fb->PhaseStepSave = PhaseStepSave;
+  fb->FIR_Coeffs = FIR_Coeffs;
+  fb->FIR_Coeffs_Real = FIR_Coeffs_Real;
+
+  FilterBanks.push_back(fb);
+  UseFilterBank(fb);
+ }
 }
@@ -5,6 +5,7 @@
 
 class OwlResampler;
 class RavenBuffer;
+struct OwlFilterBank;
 
 class OwlBuffer
 {
@@ -101,6 +102,9 @@ class OwlResampler
 	~OwlResampler() MDFN_COLD;
 
 	int32 Resample(OwlBuffer* in, const uint32 in_count, int16* out, const uint32 max_out_count);
+
+	// Same as Resample() on in_l with out and in_r with out + 1, but with one pass over the filter for both channels.
+	int32 ResampleStereo(OwlBuffer* in_l, OwlBuffer* in_r, const uint32 in_count, int16* out, const uint32 max_out_count);
 	void ResetBufResampState(OwlBuffer* buf);
 
 	// Get the InputRate / OutputRate ratio, expressed as a / b
@@ -112,6 +116,13 @@ class OwlResampler
 
 	private:
 
+	void Debias(OwlBuffer* in, const int32* src, int16* out, const uint32 count);
+	void FinishBuf(OwlBuffer* in, const uint32 in_count, uint32 InputPhase, uint32 InputIndex);
+	void UseFilterBank(OwlFilterBank* fb);
+
+	// Where the tables below come from; shared with other resamplers, so they must not be modified.
+	OwlFilterBank* Bank;
+
 	// Copy of the parameters passed to the constructor
 	double InputRate, OutputRate, RateError, DebiasCorner;
 	int Quality;
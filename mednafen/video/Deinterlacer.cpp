@@ -5,130 +5,212 @@
 #include "Deinterlacer.h"
 #include "surface.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+static void ResetFieldBuffer(MDFN_Surface *fb)
+{
+ if(fb->pixels)
+   free (fb->pixels);
+
+ fb->pixels            = NULL;
+ fb->w                 = 0;
+ fb->h                 = 0;
+ fb->pitchinpix        = 0;
+ fb->format.bpp        = 0;
+ fb->format.colorspace = 0;
+ fb->format.Rshift     = 0;
+ fb->format.Gshift     = 0;
+ fb->format.Bshift     = 0;
+ fb->format.Ashift     = 0;
+}
+
 Deinterlacer::Deinterlacer()
 {
- if(FieldBuffer.pixels)
-   free (FieldBuffer.pixels);
-
- FieldBuffer.pixels            = NULL;
- FieldBuffer.w                 = 0;
- FieldBuffer.h                 = 0;
- FieldBuffer.pitchinpix        = 0;
- FieldBuffer.format.bpp        = 0;
- FieldBuffer.format.colorspace = 0;
- FieldBuffer.format.Rshift     = 0;
- FieldBuffer.format.Gshift     = 0;
- FieldBuffer.format.Bshift     = 0;
- FieldBuffer.format.Ashift     = 0;
+ FieldBuffer.pixels = NULL;
+ ResetFieldBuffer(&FieldBuffer);
 
- StateValid = false;
- PrevHeight = 0;
+ DeintType = DEINT_WEAVE;
+ ClearState();
 }
 
 Deinterlacer::~Deinterlacer()
 {
- if(FieldBuffer.pixels)
-   free (FieldBuffer.pixels);
-
- FieldBuffer.pixels            = NULL;
- FieldBuffer.w                 = 0;
- FieldBuffer.h                 = 0;
- FieldBuffer.pitchinpix        = 0;
- FieldBuffer.format.bpp        = 0;
- FieldBuffer.format.colorspace = 0;
- FieldBuffer.format.Rshift     = 0;
- FieldBuffer.format.Gshift     = 0;
- FieldBuffer.format.Bshift     = 0;
- FieldBuffer.format.Ashift     = 0;
+ ResetFieldBuffer(&FieldBuffer);
 }
 
-void Deinterlacer::Process(MDFN_Surface *surface, const MDFN_Rect &DisplayRect, int32 *LineWidths, const bool field)
+void Deinterlacer::SetType(unsigned t)
 {
- if(!FieldBuffer.pixels || FieldBuffer.w < surface->w || FieldBuffer.h < (surface->h / 2))
+ if(DeintType != t)
+ {
+  DeintType = t;
+  ClearState();
+ }
+}
+
+// Mask that clears the least-significant bit of each color component, so that
+// ((a ^ b) & mask) >> 1 can't carry from one component into the next.
+template<typename T> static INLINE T BlendMask(void);
+template<> INLINE uint32 BlendMask<uint32>(void) { return 0xFEFEFEFE; }
+template<> INLINE uint16 BlendMask<uint16>(void) { return 0xF7DE; }	// RGB565
+
+template<typename T>
+static void BlendLine(T *dest, const T *a, const T *b, const int32 w)
+{
+ const T mask = BlendMask<T>();
+ int32 x = 0;
+
+#if defined(__SSE2__)
  {
-  if(FieldBuffer.pixels)
-   free (FieldBuffer.pixels);
+  // The component LSBs are masked off, so a 16-bit lane shift is right for both pixel sizes.
+  const __m128i vmask = _mm_set1_epi32((sizeof(T) == 4) ? (uint32)mask : ((uint32)mask << 16) | mask);
+  const int32 per_vec = 16 / sizeof(T);
 
-  //FieldBuffer = new MDFN_Surface(NULL, surface->w, surface->h / 2, surface->w, surface->format);
-  FieldBuffer.format                  = surface->format;
-  FieldBuffer.pixels                  = (uint32 *)calloc(1, surface->w * (surface->h / 2) * (surface->format.bpp / 8));
-  FieldBuffer.w                       = surface->w;
-  FieldBuffer.h                       = (surface->h / 2);
-  FieldBuffer.pitchinpix              = surface->w;
-  LWBuffer.resize(FieldBuffer.h);
+  for(; x < (w & ~(per_vec - 1)); x += per_vec)
+  {
+   const __m128i va = _mm_loadu_si128((const __m128i *)&a[x]);
+   const __m128i vb = _mm_loadu_si128((const __m128i *)&b[x]);
+   const __m128i avg = _mm_add_epi32(_mm_and_si128(va, vb), _mm_srli_epi16(_mm_and_si128(_mm_xor_si128(va, vb), vmask), 1));
+
+   _mm_storeu_si128((__m128i *)&dest[x], avg);
+  }
+ }
+#endif
+
+ for(; x < w; x++)
+  dest[x] = (a[x] & b[x]) + (((a[x] ^ b[x]) & mask) >> 1);
+}
+
+//
+// Fills in the lines of the field not being displayed from the lines of the current field.
+//
+template<typename T>
+void Deinterlacer::Interpolate(MDFN_Surface *surface, const MDFN_Rect &DisplayRect, int32 *LineWidths, const bool field, const bool blend)
+{
+ T *pixels = (T *)surface->pixels;
+ const int32 pitch = surface->pitchinpix;
+
+ for(int y = 0; y < DisplayRect.h / 2; y++)
+ {
+  const int32 dly = (y * 2) + (field ^ 1) + DisplayRect.y;
+  const bool have_above = (dly - 1) >= DisplayRect.y;
+  const bool have_below = (dly + 1) < (DisplayRect.y + DisplayRect.h);
+  const int32 sly = have_above ? (dly - 1) : (dly + 1);
+  T *dest = pixels + dly * pitch + DisplayRect.x;
+
+  if(!have_above && !have_below)
+   continue;
+
+  LineWidths[dly] = LineWidths[sly];
+
+  if(blend && have_above && have_below && LineWidths[dly - 1] == LineWidths[dly + 1])
+   BlendLine<T>(dest, dest - pitch, dest + pitch, LineWidths[dly]);
+  else
+   memcpy(dest, pixels + sly * pitch + DisplayRect.x, LineWidths[dly] * sizeof(T));
  }
+}
+
+template<typename T>
+void Deinterlacer::InternalProcess(MDFN_Surface *surface, const MDFN_Rect &DisplayRect, int32 *LineWidths, const bool field)
+{
+ T *pixels = (T *)surface->pixels;
+ const int32 pitch = surface->pitchinpix;
+ const bool same_surface = (surface->pixels == PrevPixels);
+ const bool geometry_valid = StateValid && PrevHeight == DisplayRect.h && PrevField != field;
 
  //
  // We need to output with LineWidths as always being valid to handle the case of horizontal resolution change between fields
  // while in interlace mode, so clear the first LineWidths entry if it's == ~0, and
- // [...]
+ // set all relevant source line widths to the contents of DisplayRect.
+ //
  const bool LineWidths_In_Valid = (LineWidths[0] != ~0);
  if(surface->h && !LineWidths_In_Valid)
- {
   LineWidths[0] = 0;
- }
 
- for(int y = 0; y < DisplayRect.h / 2; y++)
+ if(!LineWidths_In_Valid)
  {
-  // [...]
-  // set all relevant source line widths to the contents of DisplayRect(also simplifies the src_lw and related pointer calculation code
-  // farther below.
-  if(!LineWidths_In_Valid)
+  for(int y = 0; y < DisplayRect.h / 2; y++)
    LineWidths[(y * 2) + field + DisplayRect.y] = DisplayRect.w;
+ }
 
-  if(StateValid && PrevHeight == DisplayRect.h)
-  {
-   const uint32 *src = FieldBuffer.pixels + y * FieldBuffer.pitch32;
-   uint32 *dest = surface->pixels + ((y * 2) + (field ^ 1) + DisplayRect.y) * surface->pitch32;
-   int32 *dest_lw = &LineWidths[(y * 2) + (field ^ 1) + DisplayRect.y];
-
-   *dest_lw = LWBuffer[y];
+ if(DeintType != DEINT_WEAVE)
+  Interpolate<T>(surface, DisplayRect, LineWidths, field, DeintType == DEINT_BLEND);
+ else if(geometry_valid && same_surface)
+ {
+  //
+  // Same surface as last time: the emulated video only ever writes the lines of the current field, so the
+  // previous field is still sitting in the other lines, and only its line widths need restoring.
+  //
+  for(int y = 0; y < DisplayRect.h / 2; y++)
+   LineWidths[(y * 2) + (field ^ 1) + DisplayRect.y] = LWBuffer[y];
+ }
+ else if(geometry_valid && FieldBufferValid)
+ {
+  const T *fb_pixels = (const T *)FieldBuffer.pixels;
 
-   memcpy(dest, src, LWBuffer[y] * sizeof(uint32));
-  }
-  else
+  for(int y = 0; y < DisplayRect.h / 2; y++)
   {
-   const int32 *src_lw = &LineWidths[(y * 2) + field + DisplayRect.y];
-   const uint32 *src = surface->pixels + ((y * 2) + field + DisplayRect.y) * surface->pitch32 + DisplayRect.x;
-   const int32 dly = ((y * 2) + (field + 1) + DisplayRect.y);
-   uint32 *dest = surface->pixels + dly * surface->pitch32;
-
-   if(y == 0 && field)
-   {
-      LineWidths[dly - 2] = *src_lw;
-      memset(&surface->pixels[(dly - 2) * surface->pitch32], 0, *src_lw * sizeof(uint32));
-   }
-
-   if(dly < (DisplayRect.y + DisplayRect.h))
-   {
-    LineWidths[dly] = *src_lw;
-    memcpy(dest, src, *src_lw * sizeof(uint32));
-   }
+   const int32 dly = (y * 2) + (field ^ 1) + DisplayRect.y;
+
+   LineWidths[dly] = LWBuffer[y];
+   memcpy(pixels + dly * pitch + DisplayRect.x, fb_pixels + y * FieldBuffer.pitchinpix, LWBuffer[y] * sizeof(T));
   }
+ }
+ else
+  Interpolate<T>(surface, DisplayRect, LineWidths, field, false);
 
-  //
-  //
-  //
-  //
-  //
-  //
+ //
+ // Remember this field.  The pixels themselves only need to be saved off when the surface changes between
+ // frames(e.g. when frames alternate between two surfaces); otherwise they stay put for the next field.
+ //
+ if(DeintType == DEINT_WEAVE && !same_surface)
+ {
+  T *fb_pixels = (T *)FieldBuffer.pixels;
+
+  for(int y = 0; y < DisplayRect.h / 2; y++)
   {
-   const int32 *src_lw = &LineWidths[(y * 2) + field + DisplayRect.y];
-   const uint32 *src = surface->pixels + ((y * 2) + field + DisplayRect.y) * surface->pitch32 + DisplayRect.x;
-   uint32 *dest = FieldBuffer.pixels + y * FieldBuffer.pitch32;
+   const int32 sly = (y * 2) + field + DisplayRect.y;
 
-   memcpy(dest, src, *src_lw * sizeof(uint32));
-   LWBuffer[y] = *src_lw;
+   memcpy(fb_pixels + y * FieldBuffer.pitchinpix, pixels + sly * pitch + DisplayRect.x, LineWidths[sly] * sizeof(T));
   }
+  FieldBufferValid = true;
  }
+ else
+  FieldBufferValid = false;
+
+ for(int y = 0; y < DisplayRect.h / 2; y++)
+  LWBuffer[y] = LineWidths[(y * 2) + field + DisplayRect.y];
 
+ PrevPixels = surface->pixels;
+ PrevField = field;
  PrevHeight = DisplayRect.h;
  StateValid = true;
 }
 
+void Deinterlacer::Process(MDFN_Surface *surface, const MDFN_Rect &DisplayRect, int32 *LineWidths, const bool field)
+{
+ if(!FieldBuffer.pixels || FieldBuffer.w < surface->w || FieldBuffer.h < (surface->h / 2))
+ {
+  ResetFieldBuffer(&FieldBuffer);
+
+  FieldBuffer.format                  = surface->format;
+  FieldBuffer.pixels                  = (bpp_t *)calloc(1, surface->w * (surface->h / 2) * sizeof(bpp_t));
+  FieldBuffer.w                       = surface->w;
+  FieldBuffer.h                       = (surface->h / 2);
+  FieldBuffer.pitchinpix              = surface->w;
+  LWBuffer.resize(FieldBuffer.h);
+  ClearState();
+ }
+
+ InternalProcess<bpp_t>(surface, DisplayRect, LineWidths, field);
+}
 
 void Deinterlacer::ClearState(void)
 {
  StateValid = false;
+ FieldBufferValid = false;
+ PrevField = false;
  PrevHeight = 0;
+ PrevPixels = NULL;
 }
@@ -10,16 +10,33 @@ class Deinterlacer
  Deinterlacer();
  ~Deinterlacer();
 
+ enum
+ {
+  DEINT_WEAVE = 0,	// Previous field fills in the missing lines.
+  DEINT_BOB,		// Missing lines duplicate the current field line above them.
+  DEINT_BLEND		// Missing lines average the current field lines above and below them.
+ };
+
+ void SetType(unsigned t);
+ unsigned GetType(void) { return(DeintType); }
+
  void Process(MDFN_Surface *surface, const MDFN_Rect &DisplayRect, int32 *LineWidths, const bool field);
 
  void ClearState(void);
 
  private:
 
+ template<typename T> void InternalProcess(MDFN_Surface *surface, const MDFN_Rect &DisplayRect, int32 *LineWidths, const bool field);
+ template<typename T> void Interpolate(MDFN_Surface *surface, const MDFN_Rect &DisplayRect, int32 *LineWidths, const bool field, const bool blend);
+
  MDFN_Surface FieldBuffer;
  std::vector<int32> LWBuffer;
  bool StateValid;
+ bool FieldBufferValid;
+ bool PrevField;
  int32 PrevHeight;
+ const void *PrevPixels;
+ unsigned DeintType;
 };
 
 #endif
@@ -0,0 +1,144 @@
+/*
+ * CDAFReader_Buffered tests, against a fake source that generates each frame from its offset.
+ *
+ * Build and run with "make -C tests".
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <mednafen/mednafen.h>
+#include "cdrom/CDAFReader.h"
+#include "cdrom/CDAFReader_Buffered.h"
+
+//
+// Normally in CDAFReader.cpp, which would bring in all of the decoders.
+//
+CDAFReader::CDAFReader() : LastReadPos(0)
+{
+
+}
+
+CDAFReader::~CDAFReader()
+{
+
+}
+
+void CDAFReader::Hint(uint64_t frame_offset)
+{
+
+}
+
+class FakeSource : public CDAFReader
+{
+   public:
+      FakeSource(uint64_t frame_count) : Frames(frame_count), Pos(0) { }
+
+      uint64_t FrameCount(void) { return Frames; }
+
+      static int16 Sample(uint64_t frame, unsigned ch) { return (int16)(frame * (ch ? 7 : 3)); }
+
+   private:
+      uint64_t Read_(int16 *buffer, uint64_t frames)
+      {
+         uint64_t ret = 0;
+
+         while(ret < frames && Pos < Frames)
+         {
+            buffer[ret * 2 + 0] = Sample(Pos, 0);
+            buffer[ret * 2 + 1] = Sample(Pos, 1);
+            ret++;
+            Pos++;
+         }
+
+         return ret;
+      }
+
+      bool Seek_(uint64_t frame_offset) { Pos = frame_offset; return true; }
+
+      uint64_t Frames;
+      uint64_t Pos;
+};
+
+static int failures = 0;
+
+static void CheckRead(CDAFReader *r, uint64_t offset, uint64_t frames, const char *what)
+{
+   int16 buf[588 * 2];
+   const uint64_t got = r->Read(offset, buf, frames);
+
+   if(got != frames)
+   {
+      printf("FAIL %s: read %llu frames at %llu, got %llu\n", what, (unsigned long long)frames, (unsigned long long)offset, (unsigned long long)got);
+      failures++;
+      return;
+   }
+
+   for(uint64_t i = 0; i < frames; i++)
+   {
+      if(buf[i * 2 + 0] != FakeSource::Sample(offset + i, 0) || buf[i * 2 + 1] != FakeSource::Sample(offset + i, 1))
+      {
+         printf("FAIL %s: wrong data at frame %llu\n", what, (unsigned long long)(offset + i));
+         failures++;
+         return;
+      }
+   }
+}
+
+// A read that runs past the end of a full buffer used to wait forever for the worker thread, which had no room to decode into.
+static void TestReadPastFullWindow(void)
+{
+   CDAFReader *r = CDAFR_Buffered_Open(new FakeSource(588 * 75 * 60));
+
+   CheckRead(r, 0, 588, "full window, first read");
+   usleep(200 * 1000);	// Let the worker thread fill the buffer.
+   CheckRead(r, 131200, 588, "full window, read past its end");
+
+   delete r;
+}
+
+static void TestSequential(void)
+{
+   CDAFReader *r = CDAFR_Buffered_Open(new FakeSource(588 * 75 * 20));
+
+   for(uint64_t sector = 0; sector < 75 * 20; sector++)
+      CheckRead(r, sector * 588, 588, "sequential");
+
+   delete r;
+}
+
+static void TestSeeks(void)
+{
+   CDAFReader *r = CDAFR_Buffered_Open(new FakeSource(588 * 75 * 60));
+
+   srand(1);
+   for(unsigned i = 0; i < 200; i++)
+   {
+      const uint64_t offset = (uint64_t)(rand() % (75 * 59)) * 588;
+
+      r->Hint(offset);
+      CheckRead(r, offset, 588, "seek");
+      CheckRead(r, offset + 588, 588, "seek, next sector");
+   }
+
+   delete r;
+}
+
+int main(int argc, char *argv[])
+{
+   alarm(60);	// Fail on a hang rather than wait forever.
+
+   TestReadPastFullWindow();
+   TestSequential();
+   TestSeeks();
+
+   if(failures)
+   {
+      printf("%d failure(s)\n", failures);
+      return 1;
+   }
+
+   printf("All CDAFReader_Buffered tests passed.\n");
+   return 0;
+}